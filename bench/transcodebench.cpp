@@ -0,0 +1,629 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Headless transcoding throughput benchmark.
+ *
+ * Encodes synthetic fixtures (a CD-quality WAV and FLAC and a 96 kHz/24-bit
+ * FLAC) to every TranscodingFormat and TranscodingQuality with each
+ * available backend, through TranscodingManager as the plugin does, and
+ * reports the encode speed relative to realtime, CPU time, peak memory of
+ * the transcoder and the output bitrate.
+ *
+ * The fixtures are generated from a fixed seed, so runs on the same
+ * machine are comparable across commits: save one with --json and pass
+ * it to --compare on the next run. Each measurement runs in a child
+ * process of its own so the peak memory is that of the one encode.
+ */
+
+#include "../src/core/transcodingmanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QProcess>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using Chromecast::TranscodingFormat;
+using Chromecast::TranscodingManager;
+using Chromecast::TranscodingQuality;
+
+namespace {
+constexpr int DefaultDuration = 120; // Seconds of audio in each fixture
+constexpr int DefaultRepeat   = 3;
+constexpr int JsonVersion     = 1;
+
+struct Fixture
+{
+    const char* name;
+    int sampleRate;
+    int bitDepth;
+    TranscodingFormat container;
+};
+
+// What people cast: CD rips as WAV and FLAC, and hi-res FLAC the receiver
+// needs converted down
+constexpr std::array Fixtures{
+    Fixture{"wav-44k16", 44100, 16, TranscodingFormat::WAV},
+    Fixture{"flac-44k16", 44100, 16, TranscodingFormat::FLAC},
+    Fixture{"flac-96k24", 96000, 24, TranscodingFormat::FLAC},
+};
+
+struct Format
+{
+    const char* name;
+    TranscodingFormat format;
+};
+
+constexpr std::array Formats{
+    Format{"aac", TranscodingFormat::AAC},
+    Format{"mp3", TranscodingFormat::MP3},
+    Format{"opus", TranscodingFormat::Opus},
+    Format{"flac", TranscodingFormat::FLAC},
+    Format{"vorbis", TranscodingFormat::Vorbis},
+    Format{"wav", TranscodingFormat::WAV},
+};
+
+struct Quality
+{
+    const char* name;
+    TranscodingQuality quality;
+};
+
+constexpr std::array Qualities{
+    Quality{"high", TranscodingQuality::High},
+    Quality{"balanced", TranscodingQuality::Balanced},
+    Quality{"efficient", TranscodingQuality::Efficient},
+};
+
+struct Backend
+{
+    const char* name;
+    TranscodingManager::Backend backend;
+};
+
+constexpr std::array Backends{
+    Backend{"process", TranscodingManager::Backend::Process},
+    Backend{"library", TranscodingManager::Backend::Library},
+};
+
+struct Case
+{
+    Fixture fixture;
+    QString sourcePath;
+    Format format;
+    Quality quality;
+    Backend backend;
+    bool lossless{false}; // Quality makes no difference
+
+    [[nodiscard]] QString key() const
+    {
+        return QStringList{fixture.name, format.name, lossless ? QStringLiteral("-") : quality.name, backend.name}
+            .join('/');
+    }
+};
+
+struct Measurement
+{
+    bool ok{false};
+    QString error;
+    double wallSeconds{0.0};
+    double cpuSeconds{0.0};
+    qint64 peakRssKiB{0};
+    qint64 outputBytes{0};
+};
+
+// Selected entries of table by name, all of them if names is empty
+template <typename Entry, size_t N>
+std::vector<Entry> select(const std::array<Entry, N>& table, const QStringList& names, QString& error)
+{
+    if (names.isEmpty()) {
+        return {table.cbegin(), table.cend()};
+    }
+
+    std::vector<Entry> selected;
+    for (const QString& name : names) {
+        const auto it = std::find_if(table.cbegin(), table.cend(),
+                                     [&name](const Entry& entry) { return name.compare(entry.name) == 0; });
+        if (it == table.cend()) {
+            error = QString("Unknown name: %1").arg(name);
+            return {};
+        }
+        selected.push_back(*it);
+    }
+    return selected;
+}
+
+QStringList splitList(const QString& value)
+{
+    return value.split(',', Qt::SkipEmptyParts);
+}
+
+bool isLossless(TranscodingFormat format)
+{
+    return TranscodingManager::bitrate(format, TranscodingQuality::High) <= 0
+        && TranscodingManager::vbrQuality(format, TranscodingQuality::High) < 0;
+}
+
+// A chord with a slow tremolo over low-level noise: lossless encoders can't
+// squeeze it to nothing and lossy ones have something to spend bits on.
+// The noise comes from minstd_rand, which is the same everywhere.
+bool writeWav(const QString& path, int sampleRate, int bitDepth, int seconds)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    constexpr int Channels    = 2;
+    const int bytesPerSample  = bitDepth / 8;
+    const qint64 frames       = static_cast<qint64>(sampleRate) * seconds;
+    const auto dataBytes      = static_cast<quint32>(frames * Channels * bytesPerSample);
+
+    QByteArray header;
+    auto put = [&header](quint32 value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            header.append(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    };
+    header.append("RIFF");
+    put(36 + dataBytes, 4);
+    header.append("WAVEfmt ");
+    put(16, 4); // Format chunk size
+    put(1, 2);  // Integer PCM
+    put(Channels, 2);
+    put(sampleRate, 4);
+    put(sampleRate * Channels * bytesPerSample, 4);
+    put(Channels * bytesPerSample, 2);
+    put(bitDepth, 2);
+    header.append("data");
+    put(dataBytes, 4);
+    if (file.write(header) != header.size()) {
+        return false;
+    }
+
+    constexpr std::array Tones{220.0, 277.18, 329.63, 440.0, 1760.0};
+    constexpr double TwoPi = 2.0 * std::numbers::pi;
+    const double maxValue  = static_cast<double>((1 << (bitDepth - 1)) - 1);
+
+    std::minstd_rand noise{1};
+    auto nextNoise = [&noise]() {
+        return 2.0 * static_cast<double>(noise() - std::minstd_rand::min())
+                 / static_cast<double>(std::minstd_rand::max() - std::minstd_rand::min())
+             - 1.0;
+    };
+
+    QByteArray block;
+    for (qint64 frame = 0; frame < frames; ++frame) {
+        const double time = static_cast<double>(frame) / sampleRate;
+
+        double value{0.0};
+        for (const double tone : Tones) {
+            value += std::sin(TwoPi * tone * time) / static_cast<double>(Tones.size());
+        }
+        value *= 0.5 + 0.3 * std::sin(TwoPi * 0.5 * time);
+
+        for (int channel = 0; channel < Channels; ++channel) {
+            const double sample = value * (channel == 0 ? 1.0 : 0.9) + 0.02 * nextNoise();
+            const auto pcm      = static_cast<qint32>(std::lround(std::clamp(sample, -1.0, 1.0) * maxValue));
+            for (int i = 0; i < bytesPerSample; ++i) {
+                block.append(static_cast<char>((pcm >> (8 * i)) & 0xff));
+            }
+        }
+
+        if (block.size() >= 64 * 1024) {
+            if (file.write(block) != block.size()) {
+                return false;
+            }
+            block.clear();
+        }
+    }
+    return file.write(block) == block.size();
+}
+
+// Run one job with playback priority to its end
+bool runJob(TranscodingManager& manager, const QString& sourcePath, const QString& destPath,
+            TranscodingFormat format, TranscodingQuality quality, QString& error)
+{
+    QEventLoop loop;
+    bool ended{false};
+    bool failed{false};
+    QObject::connect(&manager, &TranscodingManager::transcodingError, &loop,
+                     [&failed, &error](const QString& /*sourcePath*/, const QString& message) {
+                         failed = true;
+                         error  = message;
+                     });
+    // A job that can't start may end before transcode() returns
+    QObject::connect(&manager, &TranscodingManager::jobEnded, &loop, [&loop, &ended]() {
+        ended = true;
+        loop.quit();
+    });
+
+    if (manager.transcode(sourcePath, destPath, format, quality, TranscodingManager::Priority::Playback) == 0) {
+        if (error.isEmpty()) {
+            error = "Transcode could not be queued";
+        }
+        return false;
+    }
+    if (!ended) {
+        loop.exec();
+    }
+    return !failed && QFileInfo::exists(destPath);
+}
+
+// Fixtures in dir, the lossless formats encoded by the manager from WAV
+std::vector<Case> createFixtures(const std::vector<Fixture>& fixtures, const QString& dir, int seconds,
+                                 QTextStream& err)
+{
+    TranscodingManager manager;
+    // Keep the fixture's rate and depth
+    Chromecast::DeviceCapabilities capabilities;
+    capabilities.maxSampleRate = 192000;
+    capabilities.maxBitDepth   = 24;
+    manager.setDeviceCapabilities(capabilities);
+
+    std::vector<Case> sources;
+    for (const Fixture& fixture : fixtures) {
+        const QString wavPath = QString("%1/%2-%3.wav").arg(dir).arg(fixture.sampleRate).arg(fixture.bitDepth);
+        if (!QFileInfo::exists(wavPath) && !writeWav(wavPath, fixture.sampleRate, fixture.bitDepth, seconds)) {
+            err << "Cannot write " << wavPath << Qt::endl;
+            continue;
+        }
+
+        QString sourcePath = wavPath;
+        if (fixture.container != TranscodingFormat::WAV) {
+            sourcePath = QString("%1/%2.%3").arg(dir, fixture.name,
+                                                  TranscodingManager::fileExtension(fixture.container));
+            QString error;
+            if (!runJob(manager, wavPath, sourcePath, fixture.container, TranscodingQuality::High, error)) {
+                err << "Cannot create fixture " << fixture.name << ": " << error << Qt::endl;
+                continue;
+            }
+        }
+
+        sources.push_back({fixture, sourcePath, {}, {}, {}});
+    }
+    return sources;
+}
+
+// Peak resident memory in KiB and CPU seconds so far, of this process or
+// of the child processes it has waited for
+Measurement resourceUsage(bool children)
+{
+    Measurement usage;
+#ifdef Q_OS_UNIX
+    rusage ru{};
+    if (getrusage(children ? RUSAGE_CHILDREN : RUSAGE_SELF, &ru) == 0) {
+        auto seconds     = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) + tv.tv_usec / 1e6; };
+        usage.cpuSeconds = seconds(ru.ru_utime) + seconds(ru.ru_stime);
+#ifdef Q_OS_MACOS
+        usage.peakRssKiB = ru.ru_maxrss / 1024; // Bytes here, KiB elsewhere
+#else
+        usage.peakRssKiB = ru.ru_maxrss;
+#endif
+    }
+#else
+    Q_UNUSED(children)
+#endif
+    return usage;
+}
+
+// Child process side: run one encode and print the measurement as JSON.
+// The wall and CPU time include probing the source, as they would in use.
+int runCase(const QString& sourcePath, const QString& outputPath, const Format& format, const Quality& quality,
+            const Backend& backend)
+{
+    TranscodingManager manager;
+    manager.setBackend(backend.backend);
+
+    const Measurement selfBefore     = resourceUsage(false);
+    const Measurement childrenBefore = resourceUsage(true);
+    QElapsedTimer timer;
+    timer.start();
+
+    Measurement result;
+    result.ok          = runJob(manager, sourcePath, outputPath, format.format, quality.quality, result.error);
+    result.wallSeconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+
+    const Measurement self     = resourceUsage(false);
+    const Measurement children = resourceUsage(true);
+    result.cpuSeconds = (self.cpuSeconds - selfBefore.cpuSeconds) + (children.cpuSeconds - childrenBefore.cpuSeconds);
+    // ffmpeg for the process backend, this process for the library one
+    result.peakRssKiB  = backend.backend == TranscodingManager::Backend::Process ? children.peakRssKiB
+                                                                                 : self.peakRssKiB;
+    result.outputBytes = QFileInfo(outputPath).size();
+
+    const QJsonObject json{
+        {"ok", result.ok},
+        {"error", result.error},
+        {"wallSeconds", result.wallSeconds},
+        {"cpuSeconds", result.cpuSeconds},
+        {"peakRssKiB", result.peakRssKiB},
+        {"outputBytes", result.outputBytes},
+    };
+    QTextStream(stdout) << QJsonDocument(json).toJson(QJsonDocument::Compact) << Qt::endl;
+    return result.ok ? 0 : 1;
+}
+
+// Parent side: run one measurement in a fresh copy of this program
+Measurement measure(const Case& benchCase, const QString& outputPath)
+{
+    const QStringList args{"--case-source", benchCase.sourcePath, "--case-output", outputPath,
+                           "--formats",     benchCase.format.name, "--qualities", benchCase.quality.name,
+                           "--backends",    benchCase.backend.name};
+
+    QProcess child;
+    child.start(QCoreApplication::applicationFilePath(), args);
+    child.waitForFinished(-1);
+    QFile::remove(outputPath);
+
+    Measurement result;
+    const QList<QByteArray> lines = child.readAllStandardOutput().trimmed().split('\n');
+    const QJsonObject json        = QJsonDocument::fromJson(lines.constLast()).object();
+    if (json.isEmpty()) {
+        const QByteArray stderrOutput = child.readAllStandardError().trimmed();
+        result.error = stderrOutput.isEmpty() ? child.errorString()
+                                              : QString::fromUtf8(stderrOutput.split('\n').constLast());
+        return result;
+    }
+
+    result.ok          = json.value("ok").toBool();
+    result.error       = json.value("error").toString();
+    result.wallSeconds = json.value("wallSeconds").toDouble();
+    result.cpuSeconds  = json.value("cpuSeconds").toDouble();
+    result.peakRssKiB  = json.value("peakRssKiB").toInteger();
+    result.outputBytes = json.value("outputBytes").toInteger();
+    return result;
+}
+
+// Speed of each case in a file written by --json
+QHash<QString, double> loadBaseline(const QString& path, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return {};
+    }
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (json.value("version").toInt() != JsonVersion) {
+        error = "Not a benchmark result of this version";
+        return {};
+    }
+
+    QHash<QString, double> speeds;
+    const QJsonArray results = json.value("results").toArray();
+    for (const QJsonValue& value : results) {
+        const QJsonObject result = value.toObject();
+        if (result.value("ok").toBool()) {
+            speeds.insert(result.value("case").toString(), result.value("speed").toDouble());
+        }
+    }
+    return speeds;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Keeps the transcode cache apart from the player's
+    QCoreApplication::setApplicationName("chromecast-transcode-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures how fast each transcoding format and quality encodes");
+    parser.addHelpOption();
+
+    const QCommandLineOption durationOption("duration", "Seconds of audio in each fixture.", "seconds",
+                                            QString::number(DefaultDuration));
+    const QCommandLineOption repeatOption("repeat", "Runs of each case; the median is reported.", "count",
+                                          QString::number(DefaultRepeat));
+    const QCommandLineOption fixturesOption("fixtures", "Fixtures to encode: wav-44k16, flac-44k16, flac-96k24.",
+                                            "list");
+    const QCommandLineOption formatsOption("formats", "Formats: aac, mp3, opus, flac, vorbis, wav.", "list");
+    const QCommandLineOption qualitiesOption("qualities", "Qualities: high, balanced, efficient.", "list");
+    const QCommandLineOption backendsOption("backends", "Backends: process, library.", "list");
+    const QCommandLineOption jsonOption("json", "Also write the results to file.", "file");
+    const QCommandLineOption labelOption("label", "Stored with the results, e.g. a commit.", "text");
+    const QCommandLineOption compareOption("compare", "Show the speed change against a file from --json.",
+                                           "file");
+    const QCommandLineOption verboseOption("verbose", "Show the transcoder's log.");
+    QCommandLineOption caseSourceOption("case-source", "", "path");
+    QCommandLineOption caseOutputOption("case-output", "", "path");
+    caseSourceOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    caseOutputOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOptions({durationOption, repeatOption, fixturesOption, formatsOption, qualitiesOption, backendsOption,
+                       jsonOption, labelOption, compareOption, verboseOption, caseSourceOption, caseOutputOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QString error;
+    const auto fixtures  = select(Fixtures, splitList(parser.value(fixturesOption)), error);
+    const auto formats   = select(Formats, splitList(parser.value(formatsOption)), error);
+    const auto qualities = select(Qualities, splitList(parser.value(qualitiesOption)), error);
+    auto backends        = select(Backends, splitList(parser.value(backendsOption)), error);
+    if (!error.isEmpty()) {
+        err << error << Qt::endl;
+        return 2;
+    }
+
+    if (parser.isSet(caseSourceOption)) {
+        if (formats.size() != 1 || qualities.size() != 1 || backends.size() != 1) {
+            err << "A case needs exactly one format, quality and backend" << Qt::endl;
+            return 2;
+        }
+        return runCase(parser.value(caseSourceOption), parser.value(caseOutputOption), formats.front(),
+                       qualities.front(), backends.front());
+    }
+
+    std::erase_if(backends,
+                  [](const Backend& backend) { return !TranscodingManager::isBackendAvailable(backend.backend); });
+    const int duration = std::max(1, parser.value(durationOption).toInt());
+    const int repeat   = std::max(1, parser.value(repeatOption).toInt());
+
+    QHash<QString, double> baseline;
+    if (parser.isSet(compareOption)) {
+        baseline = loadBaseline(parser.value(compareOption), error);
+        if (!error.isEmpty()) {
+            err << "Cannot read " << parser.value(compareOption) << ": " << error << Qt::endl;
+            return 2;
+        }
+    }
+
+    const QTemporaryDir dir;
+    if (!dir.isValid()) {
+        err << "Cannot create a temporary directory: " << dir.errorString() << Qt::endl;
+        return 1;
+    }
+
+    err << "Creating " << duration << " s fixtures..." << Qt::endl;
+    const std::vector<Case> sources = createFixtures(fixtures, dir.path(), duration, err);
+
+    std::vector<Case> cases;
+    for (const Case& source : sources) {
+        for (const Backend& backend : backends) {
+            for (const Format& format : formats) {
+                const bool lossless = isLossless(format.format);
+                for (const Quality& quality : qualities) {
+                    Case benchCase     = source;
+                    benchCase.format   = format;
+                    benchCase.quality  = quality;
+                    benchCase.backend  = backend;
+                    benchCase.lossless = lossless;
+                    cases.push_back(benchCase);
+                    if (lossless) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    out << QString("%1 %2 %3 %4 %5 %6")
+               .arg(QStringLiteral("Case"), -34)
+               .arg(QStringLiteral("Speed"), 9)
+               .arg(QStringLiteral("CPU s"), 8)
+               .arg(QStringLiteral("Peak RSS"), 10)
+               .arg(QStringLiteral("kbit/s"), 7)
+               .arg(baseline.isEmpty() ? QString{} : QStringLiteral("Change"), 8)
+               .trimmed()
+        << Qt::endl;
+
+    QJsonArray results;
+    int failures{0};
+    for (const Case& benchCase : cases) {
+        const QString outputPath = QString("%1/output.%2")
+                                       .arg(dir.path(), TranscodingManager::fileExtension(benchCase.format.format));
+
+        std::vector<Measurement> runs;
+        for (int run = 0; run < repeat; ++run) {
+            runs.push_back(measure(benchCase, outputPath));
+            if (!runs.back().ok) {
+                break;
+            }
+        }
+        std::sort(runs.begin(), runs.end(), [](const Measurement& a, const Measurement& b) {
+            return a.ok != b.ok ? !a.ok : a.wallSeconds < b.wallSeconds;
+        });
+        // A failed run sorts first and is reported as such
+        const Measurement& median = runs.front().ok ? runs.at(runs.size() / 2) : runs.front();
+
+        QJsonObject result{{"case", benchCase.key()}, {"ok", median.ok}};
+        if (!median.ok) {
+            ++failures;
+            result.insert("error", median.error);
+            out << QString("%1 failed: %2").arg(benchCase.key(), -34).arg(median.error) << Qt::endl;
+            results.append(result);
+            continue;
+        }
+
+        const double speed = median.wallSeconds > 0.0 ? duration / median.wallSeconds : 0.0;
+        const double kbps  = static_cast<double>(median.outputBytes) * 8.0 / duration / 1000.0;
+        QString change;
+        if (baseline.contains(benchCase.key()) && baseline.value(benchCase.key()) > 0.0) {
+            change = QString("%1%2%").arg(speed >= baseline.value(benchCase.key()) ? "+" : "")
+                         .arg((speed / baseline.value(benchCase.key()) - 1.0) * 100.0, 0, 'f', 1);
+        }
+
+        out << QString("%1 %2x %3 %4 %5 %6")
+                   .arg(benchCase.key(), -34)
+                   .arg(speed, 8, 'f', 1)
+                   .arg(median.cpuSeconds, 8, 'f', 2)
+                   .arg(QString("%1 MiB").arg(static_cast<double>(median.peakRssKiB) / 1024.0, 0, 'f', 1), 10)
+                   .arg(kbps, 7, 'f', 0)
+                   .arg(change, 8)
+                   .trimmed()
+            << (speed < 1.0 ? "  slower than realtime" : "") << Qt::endl;
+
+        result.insert("speed", speed);
+        result.insert("wallSeconds", median.wallSeconds);
+        result.insert("cpuSeconds", median.cpuSeconds);
+        result.insert("peakRssKiB", median.peakRssKiB);
+        result.insert("kbps", kbps);
+        results.append(result);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        const QJsonObject json{
+            {"version", JsonVersion},
+            {"label", parser.value(labelOption)},
+            {"host",
+             QJsonObject{{"os", QSysInfo::prettyProductName()},
+                         {"kernel", QSysInfo::kernelVersion()},
+                         {"cpu", QSysInfo::currentCpuArchitecture()},
+                         {"threads", QThread::idealThreadCount()}}},
+            {"duration", duration},
+            {"repeat", repeat},
+            {"results", results},
+        };
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(json).toJson()) < 0) {
+            err << "Cannot write " << file.fileName() << ": " << file.errorString() << Qt::endl;
+            return 1;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -26,6 +26,7 @@
 #include "core/chromecastoutput.h"
 #include "integration/trackmetadata.h"
 #include "integration/playbackintegrator.h"
+#include "integration/pretranscoder.h"
 #include "ui/devicewidget.h"
 #include "ui/chromecastsettingspage.h"
 
@@ -58,6 +59,13 @@ Fooyin::OutputCreator ChromecastPlugin::creator() const
             m_playerController
         );
 
+        if (m_settings && m_settings->contains("Chromecast/LiveStreaming")) {
+            output->setLiveStreaming(
+                m_settings->value("Chromecast/LiveStreaming").toBool(),
+                static_cast<TranscodingFormat>(m_settings->value("Chromecast/LiveFormat").toInt()),
+                m_settings->value("Chromecast/LivePcmBits").toInt());
+        }
+
         // Set the selected device if one has been chosen
         if (!m_selectedDeviceId.isEmpty()) {
             output->setDevice(m_selectedDeviceId);
@@ -83,12 +91,56 @@ void ChromecastPlugin::initialise(const Fooyin::CorePluginContext& context)
     m_metadataExtractor = new TrackMetadataExtractor(this);
     m_playbackIntegrator = new PlaybackIntegrator(m_communicationManager, m_httpServer,
                                                    m_transcodingManager, m_metadataExtractor, this);
+    // Before the pre-transcoder connects, so that the receiver's
+    // capabilities are set by the time it looks at the queue on connect
+    connect(m_communicationManager, &CommunicationManager::connectionStatusChanged,
+            this, &ChromecastPlugin::onConnectionStatusChanged);
+    m_preTranscoder = new PreTranscoder(m_transcodingManager, m_communicationManager, m_playerController,
+                                        context.playlistHandler, this);
 
     // Start HTTP server - use default port 8010 if setting doesn't exist
     quint16 serverPort = 8010;
     if (m_settings->contains("Chromecast/ServerPort")) {
         serverPort = m_settings->value("Chromecast/ServerPort").toInt();
     }
+    if (m_settings->contains("Chromecast/HttpWorkerThreads")) {
+        m_httpServer->setWorkerThreadCount(m_settings->value("Chromecast/HttpWorkerThreads").toInt());
+    }
+    if (m_settings->contains("Chromecast/CoverCacheSize")) {
+        m_httpServer->setCoverCacheSize(m_settings->value("Chromecast/CoverCacheSize").toLongLong() * 1024 * 1024);
+    }
+    if (m_settings->contains("Chromecast/CoverMaxSize")) {
+        m_httpServer->setCoverMaxDimension(m_settings->value("Chromecast/CoverMaxSize").toInt());
+    }
+    if (m_settings->contains("Chromecast/DefaultFormat") && m_settings->contains("Chromecast/DefaultQuality")) {
+        m_transcodingManager->setOutputFormat(
+            static_cast<TranscodingFormat>(m_settings->value("Chromecast/DefaultFormat").toInt()),
+            static_cast<TranscodingQuality>(m_settings->value("Chromecast/DefaultQuality").toInt()));
+    }
+    if (m_settings->contains("Chromecast/KeepLossless")) {
+        m_transcodingManager->setKeepLossless(m_settings->value("Chromecast/KeepLossless").toBool());
+    }
+    if (m_settings->contains("Chromecast/PreTranscodeTracks")) {
+        m_preTranscoder->setLookahead(m_settings->value("Chromecast/PreTranscodeTracks").toInt());
+    }
+    if (m_settings->contains("Chromecast/TranscodeBackend")) {
+        m_transcodingManager->setBackend(
+            static_cast<TranscodingManager::Backend>(m_settings->value("Chromecast/TranscodeBackend").toInt()));
+    }
+    if (m_settings->contains("Chromecast/TranscodeWorkers")) {
+        m_transcodingManager->setMaxConcurrentJobs(m_settings->value("Chromecast/TranscodeWorkers").toInt());
+    }
+    if (m_settings->contains("Chromecast/BackgroundNice")) {
+        m_transcodingManager->setSchedulingClass(
+            TranscodingManager::Priority::Background,
+            {m_settings->value("Chromecast/BackgroundNice").toInt(),
+             m_settings->value("Chromecast/BackgroundIdleIo").toBool(),
+             m_settings->value("Chromecast/BackgroundThreads").toInt()});
+    }
+    if (m_settings->contains("Chromecast/TranscodeCacheSize")) {
+        m_transcodingManager->setCacheSize(m_settings->value("Chromecast/TranscodeCacheSize").toLongLong() * 1024
+                                           * 1024);
+    }
     qInfo() << "Starting HTTP server on port" << serverPort;
     if (!m_httpServer->start(serverPort)) {
         qWarning() << "Failed to start HTTP server on port" << serverPort;
@@ -97,10 +149,14 @@ void ChromecastPlugin::initialise(const Fooyin::CorePluginContext& context)
     }
 
     // Connect signals
-    connect(m_communicationManager, &CommunicationManager::connectionStatusChanged,
-            this, &ChromecastPlugin::onConnectionStatusChanged);
+    connect(m_transcodingManager, &TranscodingManager::outputOpened, m_httpServer, &HttpServer::beginGrowingFile);
+    connect(m_transcodingManager, &TranscodingManager::outputClosed, m_httpServer, &HttpServer::finishGrowingFile);
+    connect(m_preTranscoder, &PreTranscoder::upcomingFilesChanged, m_httpServer, [this](const QStringList& files) {
+        m_httpServer->retainMedia(MediaRegistry::Holder::Upcoming, files);
+    });
     connect(m_communicationManager, &CommunicationManager::playbackStatusChanged,
             this, &ChromecastPlugin::onPlaybackStatusChanged);
+    connect(m_httpServer, &HttpServer::linkMeasured, this, &ChromecastPlugin::updateBitrateLimit);
 
     // Register Chromecast as an audio output
     if (auto* engineController = context.engine) {
@@ -120,12 +176,18 @@ void ChromecastPlugin::initialise(const Fooyin::GuiPluginContext& context)
 
     // Create UI components
     m_deviceWidget = new DeviceWidget(m_discoveryManager, m_communicationManager);
-    m_settingsPage = new ChromecastSettingsPage(m_settings, m_transcodingManager, m_discoveryManager, m_communicationManager);
+    m_deviceWidget->setTranscodingManager(m_transcodingManager);
+    m_settingsPage = new ChromecastSettingsPage(m_settings, m_transcodingManager, m_discoveryManager,
+                                                m_communicationManager, m_httpServer);
 
     // Register widgets
     m_widgetProvider->registerWidget(
         "ChromecastDeviceSelector",
-        [this]() { return new DeviceWidget(m_discoveryManager, m_communicationManager); },
+        [this]() {
+            auto* widget = new DeviceWidget(m_discoveryManager, m_communicationManager);
+            widget->setTranscodingManager(m_transcodingManager);
+            return widget;
+        },
         "Chromecast Device Selector"
     );
 
@@ -163,7 +225,36 @@ void ChromecastPlugin::onPlaybackStatusChanged(Chromecast::PlaybackStatus status
 void ChromecastPlugin::onConnectionStatusChanged(Chromecast::ConnectionStatus status)
 {
     qInfo() << "Connection status changed:" << static_cast<int>(status);
+
+    if (status == ConnectionStatus::Connected && m_httpServer) {
+        // Serve media on the address this device actually talks to
+        m_httpServer->setReceiverAddress(m_communicationManager->deviceAddress(),
+                                         m_communicationManager->localAddress());
+    }
+    if (status == ConnectionStatus::Connected && m_transcodingManager) {
+        m_transcodingManager->setDeviceCapabilities(
+            DeviceCapabilities::forModel(m_communicationManager->device().modelName));
+    }
+    // Each device has its own link history
+    updateBitrateLimit();
     // Connection status will be handled by ChromecastOutput when implemented
 }
 
+void ChromecastPlugin::updateBitrateLimit()
+{
+    if (!m_transcodingManager || !m_httpServer || !m_communicationManager) {
+        return;
+    }
+
+    // On unless turned off, also before the settings page has created the setting
+    const bool adaptive = !m_settings->contains("Chromecast/AdaptiveQuality")
+                       || m_settings->value("Chromecast/AdaptiveQuality").toBool();
+
+    int limit{0};
+    if (adaptive && m_communicationManager->isConnected()) {
+        limit = m_httpServer->sustainableBitrate(m_communicationManager->deviceAddress());
+    }
+    m_transcodingManager->setBitrateLimit(limit);
+}
+
 } // namespace Chromecast
@@ -44,6 +44,7 @@ class HttpServer;
 class TranscodingManager;
 class TrackMetadataExtractor;
 class PlaybackIntegrator;
+class PreTranscoder;
 class DeviceWidget;
 class ChromecastSettingsPage;
 
@@ -72,6 +73,8 @@ private slots:
     void onDeviceSelected(const QString& deviceId);
     void onPlaybackStatusChanged(Chromecast::PlaybackStatus status);
     void onConnectionStatusChanged(Chromecast::ConnectionStatus status);
+    // Limit transcodes to what the connected device's link sustains
+    void updateBitrateLimit();
 
 private:
     Fooyin::SettingsManager* m_settings{nullptr};
@@ -86,6 +89,7 @@ private:
     TranscodingManager* m_transcodingManager{nullptr};
     TrackMetadataExtractor* m_metadataExtractor{nullptr};
     PlaybackIntegrator* m_playbackIntegrator{nullptr};
+    PreTranscoder* m_preTranscoder{nullptr};
 
     DeviceWidget* m_deviceWidget{nullptr};
     ChromecastSettingsPage* m_settingsPage{nullptr};
@@ -75,6 +75,11 @@ bool CastSocket::isConnected() const
            && m_socket->isEncrypted();
 }
 
+QHostAddress CastSocket::localAddress() const
+{
+    return m_socket->localAddress();
+}
+
 void CastSocket::sendMessage(const extensions::api::cast_channel::CastMessage& message)
 {
     if (!isConnected()) {
@@ -43,6 +43,8 @@ public:
     void connectToDevice(const QHostAddress& address, quint16 port = 8009);
     void disconnect();
     bool isConnected() const;
+    // Local end of the connection, i.e. the address the device can route back to
+    QHostAddress localAddress() const;
 
     void sendMessage(const extensions::api::cast_channel::CastMessage& message);
 
@@ -21,6 +21,8 @@
 #include "discoverymanager.h"
 #include "communicationmanager.h"
 #include "httpserver.h"
+#include "liveencoder.h"
+#include "livestream.h"
 #include "transcodingmanager.h"
 #include "device.h"
 #include "../integration/trackmetadata.h"
@@ -29,11 +31,18 @@
 #include <core/track.h>
 
 #include <QDebug>
+#include <QFile>
 #include <QFileInfo>
-#include <QDir>
+
+#include <algorithm>
 
 namespace Chromecast {
 
+namespace {
+// Audio written ahead of what the receiver has played
+constexpr int PrebufferSeconds = 10;
+} // namespace
+
 ChromecastOutput::ChromecastOutput(DiscoveryManager* discovery,
                                    CommunicationManager* communication,
                                    HttpServer* httpServer,
@@ -59,6 +68,19 @@ ChromecastOutput::ChromecastOutput(DiscoveryManager* discovery,
         qWarning() << "PlayerController not available in ChromecastOutput";
     }
 
+    if (m_transcoder) {
+        connect(m_transcoder, &TranscodingManager::mediaProbed, this, [this](const QString& filePath) {
+            if (filePath != m_probingPath || filePath != m_currentTrackPath || !m_playerController) {
+                return;
+            }
+            m_probingPath.clear();
+            const Fooyin::Track track = m_playerController->currentTrack();
+            if (track.filepath() == filePath) {
+                startStreaming(track);
+            }
+        });
+    }
+
     // Connect to CommunicationManager's playbackStatusChanged to know when Chromecast
     // actually starts playing (critical for accurate position tracking)
     if (m_communication) {
@@ -138,6 +160,9 @@ void ChromecastOutput::uninit()
 
     m_isStreaming = false;
     m_currentTrackPath.clear();
+    m_probingPath.clear();
+    cancelTranscode();
+    stopLiveStream();
     
     // Reset timing state
     m_waitingForPlayback = false;
@@ -162,10 +187,26 @@ void ChromecastOutput::reset()
         if (currentPos != m_lastPosition && std::abs(static_cast<int64_t>(currentPos - m_lastPosition)) > 1000) {
             qInfo() << "ChromecastOutput: Detected seek from" << m_lastPosition << "ms to" << currentPos << "ms";
 
-            // Convert milliseconds to seconds for Chromecast
-            int seekPositionSeconds = static_cast<int>(currentPos / 1000);
-            m_communication->seek(seekPositionSeconds);
+            if (m_liveEncoder) {
+                // The receiver can't seek in a live stream: start a new one
+                // carrying the audio from the new position
+                m_lastPosition = currentPos;
+                startStreaming(m_playerController->currentTrack());
+                return;
+            }
+
             m_lastPosition = currentPos;
+
+            // A transcode still being written can't be seeked by the
+            // receiver: encode from the target instead
+            if (restartTranscodeAt(currentPos)) {
+                return;
+            }
+
+            // Convert milliseconds to seconds for Chromecast, relative to
+            // the start of the stream being served
+            int seekPositionSeconds = static_cast<int>(currentPos / 1000) - static_cast<int>(m_streamOffset);
+            m_communication->seek(std::max(0, seekPositionSeconds));
         }
     }
 }
@@ -177,6 +218,11 @@ void ChromecastOutput::drain()
     // For file-based streaming, we don't need to do much here
     // The HTTP server will handle serving the complete file
     m_audioBuffer.clear();
+
+    // No more audio is coming: end the live stream so the receiver finishes
+    if (m_liveEncoder) {
+        m_liveEncoder->finish();
+    }
 }
 
 void ChromecastOutput::start()
@@ -201,6 +247,15 @@ Fooyin::OutputState ChromecastOutput::currentState()
 {
     Fooyin::OutputState state;
 
+    // Hold the decoder while the track's probe decides how to cast it, so
+    // playback doesn't run ahead of the receiver
+    if (!m_probingPath.isEmpty()) {
+        state.freeSamples = 0;
+        state.queuedSamples = 0;
+        state.delay = 0.0;
+        return state;
+    }
+
     // If not streaming or not connected, return default state
     if (!m_isStreaming || !m_communication || !m_communication->isConnected()) {
         state.freeSamples = m_bufferSize;
@@ -227,6 +282,10 @@ Fooyin::OutputState ChromecastOutput::currentState()
         // from thinking we've played through all the audio
         state.queuedSamples = m_samplesWritten > 0 ? static_cast<int>(m_samplesWritten) : m_bufferSize;
         state.freeSamples = m_bufferSize;  // Allow more data to be written
+        if (m_liveEncoder && state.queuedSamples >= sampleRate * channels * PrebufferSeconds) {
+            // A live stream only needs enough to fill the receiver's buffer
+            state.freeSamples = 0;
+        }
         state.delay = static_cast<double>(state.queuedSamples) / (sampleRate * channels);
         return state;
     }
@@ -251,7 +310,7 @@ Fooyin::OutputState ChromecastOutput::currentState()
 
     // If buffer is "full" (queued > threshold), report no free space
     // This creates backpressure to slow down the decoder
-    const int maxQueuedSamples = sampleRate * channels * 10; // 10 seconds buffer
+    const int maxQueuedSamples = sampleRate * channels * PrebufferSeconds;
     state.freeSamples = (state.queuedSamples < maxQueuedSamples) ? m_bufferSize : 0;
 
     // Delay in seconds
@@ -310,6 +369,11 @@ int ChromecastOutput::write(const Fooyin::AudioBuffer& buffer)
     const int bytesCount = buffer.byteCount();
     m_audioBuffer.append(reinterpret_cast<const char*>(buffer.data()), bytesCount);
 
+    if (m_liveEncoder && m_format.channelCount() > 0) {
+        m_liveEncoder->write(reinterpret_cast<const char*>(buffer.data()),
+                             buffer.sampleCount() / m_format.channelCount());
+    }
+
     // Track playback position
     m_samplesWritten += buffer.sampleCount();
 
@@ -463,6 +527,9 @@ void ChromecastOutput::onPlayStateChanged(Fooyin::Player::PlayState state)
             m_communication->stop();
             m_isStreaming = false;
             m_currentTrackPath.clear();
+            m_probingPath.clear();
+            cancelTranscode();
+            stopLiveStream();
             break;
     }
 }
@@ -487,32 +554,48 @@ void ChromecastOutput::startStreaming(const Fooyin::Track& track)
     }
 
     m_currentTrackPath = filePath;
-
-    // Reset samples counter for new track (critical for correct position tracking)
-    m_samplesWritten = 0;
-
-    // Reset playback timing state - DON'T start timer yet!
-    // Timer will be started when Chromecast reports PLAYING state
-    m_pausedElapsed = 0;
-    m_playbackTimerStarted = false;
-    m_waitingForPlayback = true;  // Mark that we're waiting for Chromecast to start playing
-    m_playbackTimer.invalidate();  // Ensure timer is not valid until PLAYING state
+    m_probingPath.clear();
+    cancelTranscode();
+
+    // Without libav a probe runs ffprobe, which may take seconds: do it off
+    // this thread and come back here when it is done
+    if (!m_liveStreaming && m_transcoder && !m_transcoder->isProbed(filePath)) {
+        qInfo() << "Probing" << filePath << "before streaming it";
+        m_probingPath = filePath;
+        m_transcoder->probeInBackground({filePath});
+        return;
+    }
 
     // Check if file needs transcoding
     QString streamUrl;
-    if (needsTranscoding(filePath)) {
+    QString servedPath = filePath;
+    if (m_liveStreaming) {
+        streamUrl = startLiveStream();
+        if (streamUrl.isEmpty()) {
+            return;
+        }
+    } else if (needsTranscoding(filePath)) {
         qInfo() << "Track requires transcoding:" << filePath;
 
         // Trigger transcoding
         if (m_transcoder) {
-            // Create temporary file path for transcoded output
-            QString tempDir = QDir::tempPath() + "/fooyin-chromecast";
-            QDir().mkpath(tempDir);
-            QFileInfo fileInfo(filePath);
-            QString transcodedPath = QString("%1/%2.mp3").arg(tempDir, fileInfo.baseName());
-
-            if (m_transcoder->transcodeFile(filePath, transcodedPath)) {
-                streamUrl = m_httpServer->createMediaUrl(transcodedPath);
+            const TranscodingFormat format = m_transcoder->outputFormatFor(filePath);
+            const TranscodingQuality quality = m_transcoder->outputQuality();
+
+            QString outputPath = m_transcoder->cachedOutput(filePath, format, quality);
+            if (!outputPath.isEmpty()) {
+                qInfo() << "Using cached transcode:" << outputPath;
+            } else {
+                // Playback jobs start immediately and are served while ffmpeg
+                // is still writing, so LOAD doesn't wait for the whole track
+                m_transcodeJob = m_transcoder->transcode(filePath, format, quality,
+                                                         TranscodingManager::Priority::Playback);
+                outputPath = m_transcoder->outputPath(m_transcodeJob);
+            }
+
+            if (!outputPath.isEmpty()) {
+                servedPath = outputPath;
+                streamUrl = m_httpServer->createMediaUrl(outputPath);
             } else {
                 qWarning() << "Transcoding failed for:" << filePath;
                 return;
@@ -537,6 +620,23 @@ void ChromecastOutput::startStreaming(const Fooyin::Track& track)
         return;
     }
 
+    loadMedia(track, streamUrl, servedPath);
+}
+
+void ChromecastOutput::loadMedia(const Fooyin::Track& track, const QString& streamUrl, const QString& servedPath)
+{
+    const QString filePath = track.filepath();
+
+    // Reset samples counter for new track (critical for correct position tracking)
+    m_samplesWritten = 0;
+
+    // Reset playback timing state - DON'T start timer yet!
+    // Timer will be started when Chromecast reports PLAYING state
+    m_pausedElapsed = 0;
+    m_playbackTimerStarted = false;
+    m_waitingForPlayback = true;  // Mark that we're waiting for Chromecast to start playing
+    m_playbackTimer.invalidate();  // Ensure timer is not valid until PLAYING state
+
     // Extract metadata
     QString title = track.title();
     QString artist = track.artist();
@@ -546,6 +646,8 @@ void ChromecastOutput::startStreaming(const Fooyin::Track& track)
     QString coverUrl;
     if (m_httpServer) {
         coverUrl = m_httpServer->createCoverUrl(filePath);
+        // Older tracks' URLs may expire, this one's must not while it plays
+        m_httpServer->retainMedia(MediaRegistry::Holder::Playback, {filePath, servedPath});
     }
 
     qInfo() << "Sending LOAD command to Chromecast - URL:" << streamUrl;
@@ -557,15 +659,154 @@ void ChromecastOutput::startStreaming(const Fooyin::Track& track)
     m_isStreaming = true;
 }
 
-bool ChromecastOutput::needsTranscoding(const QString& filePath) const
+void ChromecastOutput::setLiveStreaming(bool enabled, TranscodingFormat format, int pcmBitsPerSample)
+{
+    if (enabled && !LiveEncoder::isFormatAvailable(format)) {
+        qWarning() << "ChromecastOutput: Live streaming as" << TranscodingManager::fileExtension(format)
+                   << "is not available, streaming files instead";
+        enabled = false;
+    }
+
+    m_liveStreaming = enabled;
+    m_liveFormat = format;
+    m_livePcmBits = pcmBitsPerSample;
+}
+
+QString ChromecastOutput::startLiveStream()
+{
+    stopLiveStream();
+
+    if (!m_httpServer) {
+        qWarning() << "HTTP server not available";
+        return {};
+    }
+
+    LiveEncoder::Options options;
+    options.format = m_liveFormat;
+    options.quality = m_transcoder ? m_transcoder->outputQuality() : TranscodingQuality::High;
+    options.pcmBitsPerSample = m_livePcmBits;
+
+    // The stream keeps the whole pre-buffer and some slack on top, at the
+    // 32-bit PCM rate that bounds every live format, so the receiver gets
+    // the track from its start and can trail the writer by that much
+    const qint64 backlogMs = PrebufferSeconds * 1000 + LiveStream::DefaultBacklogMs;
+    const qint64 byteRate = qint64{m_format.sampleRate()} * m_format.channelCount() * 4;
+    auto stream = std::make_shared<LiveStream>(
+        backlogMs, std::max(LiveStream::DefaultBacklogBytes, byteRate * backlogMs / 1000));
+    QString error;
+    m_liveEncoder = LiveEncoder::create(options, m_format, stream, error);
+    if (!m_liveEncoder) {
+        m_errorString = error;
+        qWarning() << "ChromecastOutput: Cannot start live stream:" << error;
+        return {};
+    }
+
+    m_liveStream = std::move(stream);
+    return m_httpServer->addLiveStream(m_liveStream, TranscodingManager::fileExtension(m_liveFormat));
+}
+
+void ChromecastOutput::stopLiveStream()
+{
+    if (m_liveEncoder) {
+        m_liveEncoder->finish();
+        m_liveEncoder.reset();
+    }
+    if (m_liveStream) {
+        if (m_httpServer) {
+            m_httpServer->removeLiveStream(m_liveStream);
+        }
+        m_liveStream.reset();
+    }
+}
+
+void ChromecastOutput::cancelTranscode()
+{
+    cancelSeekTranscode();
+
+    if (m_transcoder && m_transcodeJob != 0) {
+        m_transcoder->cancel(m_transcodeJob);
+    }
+    m_transcodeJob = 0;
+}
+
+void ChromecastOutput::cancelSeekTranscode()
+{
+    if (m_transcoder && m_seekJob != 0) {
+        m_transcoder->cancel(m_seekJob);
+    }
+    m_seekJob = 0;
+    m_streamOffset = 0.0;
+
+    // An open response keeps reading the unlinked file
+    if (!m_seekOutput.isEmpty()) {
+        QFile::remove(m_seekOutput);
+        m_seekOutput.clear();
+    }
+}
+
+bool ChromecastOutput::restartTranscodeAt(uint64_t positionMs)
 {
-    QFileInfo fileInfo(filePath);
-    QString extension = fileInfo.suffix().toLower();
+    if (!m_transcoder || !m_httpServer || m_currentTrackPath.isEmpty()) {
+        return false;
+    }
+
+    const double target = static_cast<double>(positionMs) / 1000.0;
+    const quint64 servedJob = m_seekJob != 0 ? m_seekJob : m_transcodeJob;
+    // An output that is still being written is served without byte ranges,
+    // so the receiver can't seek in it even where it is already encoded
+    if (servedJob == 0 || !m_transcoder->isActive(servedJob)) {
+        // The served output is complete; only a seek stream lacks the
+        // part of the track before its start
+        if (m_seekJob == 0 || target >= m_streamOffset) {
+            return false;
+        }
+    }
+
+    const TranscodingFormat format = m_transcoder->outputFormatFor(m_currentTrackPath);
+    const TranscodingQuality quality = m_transcoder->outputQuality();
+
+    if (target <= 0.0) {
+        // The full output already starts there. It belongs to the cache, so
+        // it must never become the seek output removed when done.
+        const QString outputPath = m_transcoder->isActive(m_transcodeJob)
+                                     ? m_transcoder->outputPath(m_transcodeJob)
+                                     : m_transcoder->cachedOutput(m_currentTrackPath, format, quality);
+        if (outputPath.isEmpty()) {
+            return false;
+        }
 
-    // Chromecast natively supports these formats
-    QStringList nativeFormats = {"mp3", "aac", "m4a", "opus", "flac", "ogg", "wav"};
+        qInfo() << "ChromecastOutput: Seek to the start, serving the full transcode again";
 
-    return !nativeFormats.contains(extension);
+        cancelSeekTranscode();
+        loadMedia(m_playerController->currentTrack(), m_httpServer->createMediaUrl(outputPath), outputPath);
+        return true;
+    }
+
+    cancelSeekTranscode();
+
+    // The full transcode carries on for the cache; the receiver gets a
+    // stream that starts at the target
+    const TranscodingManager::JobId job = m_transcoder->transcodeFrom(m_currentTrackPath, target, format, quality,
+                                                                      TranscodingManager::Priority::Playback);
+    const QString outputPath = m_transcoder->outputPath(job);
+    if (job == 0 || outputPath.isEmpty()) {
+        qWarning() << "ChromecastOutput: Cannot transcode from" << target << "s, seeking in the current stream";
+        return false;
+    }
+
+    qInfo() << "ChromecastOutput: Seek to" << target << "s in a stream that isn't seekable, restarting there";
+
+    m_seekJob = job;
+    m_seekOutput = outputPath;
+    m_streamOffset = target;
+
+    loadMedia(m_playerController->currentTrack(), m_httpServer->createMediaUrl(outputPath), outputPath);
+    return true;
+}
+
+bool ChromecastOutput::needsTranscoding(const QString& filePath) const
+{
+    return m_transcoder && m_transcoder->needsTranscoding(filePath);
 }
 
 void ChromecastOutput::onChromecastPlaybackStatusChanged(PlaybackStatus status)
@@ -29,6 +29,8 @@
 #include <QString>
 #include <QElapsedTimer>
 
+#include <memory>
+
 namespace Fooyin {
 class PlayerController;
 class Track;
@@ -39,6 +41,8 @@ namespace Chromecast {
 class DiscoveryManager;
 class CommunicationManager;
 class HttpServer;
+class LiveEncoder;
+class LiveStream;
 class TranscodingManager;
 class TrackMetadataExtractor;
 
@@ -82,6 +86,11 @@ public:
     [[nodiscard]] Fooyin::AudioFormat format() const override;
     [[nodiscard]] QString error() const override;
 
+    // Cast the decoded audio passed to write(), encoded to format as it
+    // arrives, instead of the track's file
+    // WAV is sent as PCM with pcmBitsPerSample (16 or 24) bits per sample
+    void setLiveStreaming(bool enabled, TranscodingFormat format, int pcmBitsPerSample = 16);
+
 private slots:
     void onTrackChanged(const Fooyin::Track& track);
     void onPlayStateChanged(Fooyin::Player::PlayState state);
@@ -89,7 +98,19 @@ private slots:
 
 private:
     void startStreaming(const Fooyin::Track& track);
+    // Reset playback tracking and send LOAD for streamUrl
+    void loadMedia(const Fooyin::Track& track, const QString& streamUrl, const QString& servedPath);
     bool needsTranscoding(const QString& filePath) const;
+    // Give up this output's interest in the current track's transcodes
+    void cancelTranscode();
+    // Serve a transcode starting at position if the receiver can't seek
+    // there in the current stream. Returns false if a plain seek will do.
+    bool restartTranscodeAt(uint64_t positionMs);
+    void cancelSeekTranscode();
+    // Start encoding write() into a new stream, returns its URL
+    QString startLiveStream();
+    void stopLiveStream();
+
     // Component pointers (not owned, except m_communication)
     DiscoveryManager* m_discovery{nullptr};
     CommunicationManager* m_communication{nullptr};  // Owned by this instance
@@ -113,7 +134,21 @@ private:
     bool m_isPaused{false};
     double m_volume{1.0};
     QString m_currentTrackPath;
+    QString m_probingPath; // Streamed once TranscodingManager has probed it
     bool m_isStreaming{false};
+    quint64 m_transcodeJob{0}; // TranscodingManager::JobId, 0 if none
+
+    // Transcode started at a seek target, served instead of m_transcodeJob
+    quint64 m_seekJob{0};
+    QString m_seekOutput;       // Removed when no longer served
+    double m_streamOffset{0.0}; // Track time in seconds at the start of the served stream
+
+    // Live streaming of the decoded audio
+    bool m_liveStreaming{false};
+    TranscodingFormat m_liveFormat{TranscodingFormat::FLAC};
+    int m_livePcmBits{16};
+    std::shared_ptr<LiveStream> m_liveStream;
+    std::unique_ptr<LiveEncoder> m_liveEncoder;
     uint64_t m_lastPosition{0}; // Track last known position for seek detection
 
     // Real-time playback tracking
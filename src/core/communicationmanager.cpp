@@ -139,6 +139,24 @@ bool CommunicationManager::isConnected() const
     return m_connectionStatus == ConnectionStatus::Connected;
 }
 
+QHostAddress CommunicationManager::deviceAddress() const
+{
+    return m_currentDevice.ipAddress;
+}
+
+DeviceInfo CommunicationManager::device() const
+{
+    return m_currentDevice;
+}
+
+QHostAddress CommunicationManager::localAddress() const
+{
+    if (!m_socket || !m_socket->isConnected()) {
+        return {};
+    }
+    return m_socket->localAddress();
+}
+
 ConnectionStatus CommunicationManager::connectionStatus() const
 {
     return m_connectionStatus;
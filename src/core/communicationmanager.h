@@ -48,6 +48,11 @@ public:
     void disconnectFromDevice();
     bool isConnected() const;
     ConnectionStatus connectionStatus() const;
+    QHostAddress deviceAddress() const;
+    // The device connected to or being connected to
+    DeviceInfo device() const;
+    // Address of this host on the route to the device, null if not connected
+    QHostAddress localAddress() const;
 
     void play(const QString& mediaUrl, const QString& title, const QString& artist, const QString& album,
               const QString& coverUrl);
@@ -0,0 +1,90 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "covercache.h"
+
+#include <QMutexLocker>
+
+namespace {
+// Rough per-entry bookkeeping cost, so negative entries are not free
+constexpr qint64 EntryOverhead = 128;
+} // namespace
+
+namespace Chromecast {
+
+CoverCache::CoverCache(qint64 maxBytes)
+    : m_cache(maxBytes)
+{ }
+
+void CoverCache::setMaxBytes(qint64 maxBytes)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(maxBytes);
+}
+
+bool CoverCache::find(const Key& key, Entry& entry)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    // object() also marks the entry as most recently used
+    const Entry* cached = m_cache.object(key);
+    if (!cached) {
+        ++m_misses;
+        return false;
+    }
+
+    if (cached->data.isEmpty()) {
+        ++m_negativeHits;
+    } else {
+        ++m_hits;
+    }
+
+    entry = *cached;
+    return true;
+}
+
+void CoverCache::insert(const Key& key, const Entry& entry)
+{
+    const qint64 cost = entry.data.size() + key.path.size() * static_cast<qint64>(sizeof(QChar)) + EntryOverhead;
+
+    const QMutexLocker locker(&m_mutex);
+    // QCache rejects (and deletes) anything larger than its whole budget
+    m_cache.insert(key, new Entry(entry), cost);
+}
+
+void CoverCache::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+CoverCache::Stats CoverCache::stats() const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    Stats stats;
+    stats.hits = m_hits;
+    stats.negativeHits = m_negativeHits;
+    stats.misses = m_misses;
+    stats.usedBytes = m_cache.totalCost();
+    stats.maxBytes = m_cache.maxCost();
+    return stats;
+}
+
+} // namespace Chromecast
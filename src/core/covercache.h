@@ -0,0 +1,96 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QHashFunctions>
+#include <QMutex>
+#include <QString>
+
+namespace Chromecast {
+
+/*!
+ * Bounded, thread-safe LRU cache of extracted cover art.
+ *
+ * Entries are keyed by the media file's path, size and modification time,
+ * so a retagged file simply misses and its stale entry ages out. Tracks
+ * without art are cached as empty entries so repeated requests for them
+ * don't cost a tag parse each time.
+ */
+class CoverCache
+{
+public:
+    struct Key
+    {
+        QString path;
+        qint64 size{0};
+        qint64 modified{0};   // msecs since epoch
+        int maxDimension{0};  // Scaled variant, 0 for the original image
+
+        friend bool operator==(const Key& lhs, const Key& rhs)
+        {
+            return lhs.size == rhs.size && lhs.modified == rhs.modified && lhs.maxDimension == rhs.maxDimension
+                && lhs.path == rhs.path;
+        }
+
+        friend size_t qHash(const Key& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.path, key.size, key.modified, key.maxDimension);
+        }
+    };
+
+    struct Entry
+    {
+        QByteArray data; // Empty if the track has no cover
+        QString mimeType;
+    };
+
+    struct Stats
+    {
+        quint64 hits{0};
+        quint64 negativeHits{0};
+        quint64 misses{0};
+        qint64 usedBytes{0};
+        qint64 maxBytes{0};
+    };
+
+    static constexpr qint64 DefaultMaxBytes = 32 * 1024 * 1024;
+
+    explicit CoverCache(qint64 maxBytes = DefaultMaxBytes);
+
+    void setMaxBytes(qint64 maxBytes);
+
+    // Returns false on a miss
+    bool find(const Key& key, Entry& entry);
+    void insert(const Key& key, const Entry& entry);
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    mutable QMutex m_mutex;
+    QCache<Key, Entry> m_cache;
+    quint64 m_hits{0};
+    quint64 m_negativeHits{0};
+    quint64 m_misses{0};
+};
+
+} // namespace Chromecast
@@ -0,0 +1,85 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "devicecapabilities.h"
+
+#include "mediaprobe.h"
+
+#include <array>
+
+namespace {
+struct ModelLimits
+{
+    const char* match; // Case-insensitive part of the model name
+    int maxSampleRate;
+    int maxBitDepth;
+    int maxChannels;
+};
+
+// First match wins, so specific names go before the ones they contain
+constexpr std::array ModelTable{
+    ModelLimits{"Chromecast Audio", 96000, 24, 2},
+    ModelLimits{"Google Cast Group", 48000, 16, 2},
+    ModelLimits{"Chromecast", 96000, 24, 6}, // Chromecast, Ultra, with Google TV
+    ModelLimits{"Google TV", 96000, 24, 6},
+    ModelLimits{"Google Home", 48000, 24, 2},
+    ModelLimits{"Nest", 48000, 24, 2},
+};
+} // namespace
+
+namespace Chromecast {
+
+QString DeviceCapabilities::unsupportedReason(const MediaInfo& info) const
+{
+    if (!containers.contains(info.container)) {
+        return QString("%1 container is not supported by %2").arg(info.container, model);
+    }
+    if (!codecs.contains(info.codec)) {
+        return QString("%1 audio is not supported by %2").arg(info.codec, model);
+    }
+    if (info.sampleRate > maxSampleRate) {
+        return QString("%1 Hz is above the %2 Hz %3 plays").arg(info.sampleRate).arg(maxSampleRate).arg(model);
+    }
+    if (info.isLossless() && info.bitDepth > maxBitDepth) {
+        return QString("%1-bit is above the %2-bit %3 plays").arg(info.bitDepth).arg(maxBitDepth).arg(model);
+    }
+    if (info.channels > maxChannels) {
+        return QString("%1 channels are more than %2 plays").arg(info.channels).arg(model);
+    }
+    return {};
+}
+
+DeviceCapabilities DeviceCapabilities::forModel(const QString& modelName)
+{
+    DeviceCapabilities capabilities;
+    if (!modelName.isEmpty()) {
+        capabilities.model = modelName;
+    }
+
+    for (const ModelLimits& limits : ModelTable) {
+        if (modelName.contains(QLatin1String{limits.match}, Qt::CaseInsensitive)) {
+            capabilities.maxSampleRate = limits.maxSampleRate;
+            capabilities.maxBitDepth   = limits.maxBitDepth;
+            capabilities.maxChannels   = limits.maxChannels;
+            break;
+        }
+    }
+    return capabilities;
+}
+
+} // namespace Chromecast
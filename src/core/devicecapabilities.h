@@ -0,0 +1,52 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+namespace Chromecast {
+struct MediaInfo;
+
+/*!
+ * What a receiver model plays without transcoding, after Google's list of
+ * supported media for Cast devices.
+ *
+ * Cast speakers are held to 48 kHz and groups to 48 kHz/16-bit; Chromecast
+ * dongles take FLAC and WAV up to 96 kHz/24-bit. Unknown models (mostly third-party
+ * speakers with Cast built in) get the speaker limits.
+ */
+struct DeviceCapabilities
+{
+    QString model{"the receiver"};
+    // What every Cast receiver plays, as MediaInfo::container and codec names
+    QStringList containers{"mp3", "aac", "mp4", "ogg", "flac", "wav", "matroska"};
+    QStringList codecs{"aac", "mp3", "vorbis", "opus", "flac", "pcm_s16le", "pcm_s24le"};
+    int maxSampleRate{48000};
+    int maxBitDepth{24};    // Of lossless codecs
+    int maxChannels{2};
+
+    // Empty if the receiver can play info as it is, else why it can't
+    [[nodiscard]] QString unsupportedReason(const MediaInfo& info) const;
+
+    // For the model name a receiver advertises (the "md" TXT record)
+    static DeviceCapabilities forModel(const QString& modelName);
+};
+
+} // namespace Chromecast
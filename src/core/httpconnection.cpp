@@ -0,0 +1,726 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "httpconnection.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+namespace {
+// Size of each read from disk
+constexpr qint64 ChunkSize = 64 * 1024;
+// Never queue more than this many bytes in the socket's user-space buffer.
+// Anything beyond this waits on disk until the receiver catches up.
+constexpr qint64 HighWaterMark = 256 * 1024;
+// Upper bound on bytes handed to sendfile() per event loop iteration, so a
+// fast client can't monopolise the thread
+constexpr qint64 SendFileBurst = 4 * 1024 * 1024;
+// Close a persistent connection after this long without a request
+constexpr int IdleTimeoutMs = 15000;
+// Close a persistent connection after this many requests
+constexpr int MaxRequestsPerConnection = 100;
+// Drop clients that pipeline more than this many unanswered bytes
+constexpr qsizetype MaxPendingRequestBytes = 64 * 1024;
+// Size of each read from the socket
+constexpr qint64 ReadChunkSize = 4096;
+// How often a growing file is checked for new data once we've caught up
+constexpr int GrowthPollMs = 50;
+// Start of a response that is timed to measure the link
+constexpr qint64 RateWindowBytes = 2 * 1024 * 1024;
+// Shorter responses are too short to time
+constexpr qint64 RateMinBytes = 256 * 1024;
+// Time without anything draining that counts as a stall
+constexpr int StallTimeoutMs = 3000;
+} // namespace
+
+namespace Chromecast {
+
+HttpConnection::HttpConnection(QTcpSocket* socket, QObject* parent)
+    : QObject(parent)
+    , m_socket(socket)
+    , m_idleTimer(new QTimer(this))
+{
+    m_socket->setParent(this);
+
+    connect(m_socket, &QTcpSocket::readyRead, this, &HttpConnection::onReadyRead);
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &HttpConnection::onBytesWritten);
+    connect(m_socket, &QTcpSocket::disconnected, this, &HttpConnection::onDisconnected);
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IdleTimeoutMs);
+    connect(m_idleTimer, &QTimer::timeout, this, [this]() {
+        qDebug() << "HttpConnection: Closing idle connection from" << m_socket->peerAddress().toString();
+        m_socket->disconnectFromHost();
+    });
+    m_idleTimer->start();
+}
+
+HttpConnection::~HttpConnection()
+{
+    m_file.close();
+}
+
+QTcpSocket* HttpConnection::socket() const
+{
+    return m_socket;
+}
+
+QHostAddress HttpConnection::peerAddress() const
+{
+    return m_socket->peerAddress();
+}
+
+bool HttpConnection::isStreaming() const
+{
+    return m_streaming;
+}
+
+bool HttpConnection::keepAlive() const
+{
+    return m_keepAlive;
+}
+
+QByteArray HttpConnection::connectionHeader() const
+{
+    if (!m_keepAlive) {
+        return QByteArrayLiteral("Connection: close\r\n");
+    }
+
+    return QByteArrayLiteral("Connection: keep-alive\r\nKeep-Alive: timeout=")
+         + QByteArray::number(IdleTimeoutMs / 1000) + ", max="
+         + QByteArray::number(MaxRequestsPerConnection - m_requestCount) + "\r\n";
+}
+
+void HttpConnection::sendResponse(const QByteArray& header, const QByteArray& body)
+{
+    m_socket->write(header);
+    if (!body.isEmpty() && !m_headRequest) {
+        m_socket->write(body);
+    }
+    finishResponse();
+}
+
+bool HttpConnection::sendFile(const QByteArray& header, const QString& filePath, qint64 offset, qint64 length)
+{
+    return sendFile(header, filePath, {FileRange{{}, offset, std::max<qint64>(length, 0)}});
+}
+
+bool HttpConnection::sendFile(const QByteArray& header, const QString& filePath, std::vector<FileRange> ranges,
+                              const QByteArray& trailer)
+{
+    if (m_streaming) {
+        qWarning() << "HttpConnection: Response already in progress, ignoring request for" << filePath;
+        return false;
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "HttpConnection: Failed to open file:" << filePath << m_file.errorString();
+        return false;
+    }
+
+    if (m_headRequest) {
+        m_file.close();
+        sendResponse(header);
+        return true;
+    }
+
+    m_mode = TransferMode::Copy;
+#ifdef Q_OS_LINUX
+    struct stat st{};
+    if (m_file.handle() >= 0 && m_socket->socketDescriptor() >= 0 && ::fstat(m_file.handle(), &st) == 0
+        && S_ISREG(st.st_mode)) {
+        m_mode = TransferMode::SendFile;
+    }
+#endif
+
+    m_length = 0;
+    for (const FileRange& range : ranges) {
+        m_length += range.length;
+    }
+
+    m_ranges = std::move(ranges);
+    m_nextRange = 0;
+    m_trailer = trailer;
+    m_remaining = 0;
+    m_zeroCopyStarted = false;
+    m_streaming = true;
+
+    startRateMeasurement();
+    m_socket->write(header);
+    pumpFile();
+
+    return true;
+}
+
+bool HttpConnection::sendGrowingFile(const QByteArray& header, const QString& filePath,
+                                     std::function<bool()> isGrowing)
+{
+    if (m_streaming) {
+        qWarning() << "HttpConnection: Response already in progress, ignoring request for" << filePath;
+        return false;
+    }
+
+    // Unbuffered, so a read at EOF always goes back to the file for new data
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning() << "HttpConnection: Failed to open file:" << filePath << m_file.errorString();
+        return false;
+    }
+
+    m_isGrowing = std::move(isGrowing);
+    startGrowingStream(header);
+    return true;
+}
+
+bool HttpConnection::sendStream(const QByteArray& header, std::function<qint64(char*, qint64)> read,
+                                std::function<bool()> isGrowing)
+{
+    if (m_streaming) {
+        qWarning() << "HttpConnection: Response already in progress, ignoring stream request";
+        return false;
+    }
+
+    m_readStream = std::move(read);
+    m_isGrowing  = std::move(isGrowing);
+    startGrowingStream(header);
+    return true;
+}
+
+void HttpConnection::startGrowingStream(const QByteArray& header)
+{
+    // Without chunked encoding the only way to end the body is to close
+    m_chunked = m_http11;
+    if (!m_chunked) {
+        m_keepAlive = false;
+    }
+
+    QByteArray fullHeader = header;
+    if (m_chunked) {
+        fullHeader += "Transfer-Encoding: chunked\r\n";
+    }
+    fullHeader += connectionHeader() + "\r\n";
+
+    if (m_headRequest) {
+        m_file.close();
+        m_readStream = nullptr;
+        m_isGrowing  = nullptr;
+        sendResponse(fullHeader);
+        return;
+    }
+
+    if (!m_growthTimer) {
+        m_growthTimer = new QTimer(this);
+        m_growthTimer->setSingleShot(true);
+        m_growthTimer->setInterval(GrowthPollMs);
+        connect(m_growthTimer, &QTimer::timeout, this, &HttpConnection::pumpGrowingFile);
+    }
+
+    m_mode = TransferMode::Copy;
+    m_length = 0;
+    m_remaining = 0;
+    m_streaming = true;
+
+    startRateMeasurement();
+    m_socket->write(fullHeader);
+    pumpGrowingFile();
+}
+
+void HttpConnection::onReadyRead()
+{
+    if (m_readOffset > 0) {
+        m_readBuffer.remove(0, m_readOffset);
+        m_readOffset = 0;
+    }
+
+    while (m_socket->bytesAvailable() > 0) {
+        if (m_readBuffer.size() - m_readOffset >= MaxPendingRequestBytes) {
+            qWarning() << "HttpConnection: Too much unanswered request data from"
+                       << m_socket->peerAddress().toString();
+            m_socket->abort();
+            return;
+        }
+
+        // Read straight into the reused buffer instead of allocating via readAll()
+        const qsizetype used = m_readBuffer.size();
+        m_readBuffer.resize(used + ReadChunkSize);
+        const qint64 bytesRead = m_socket->read(m_readBuffer.data() + used, ReadChunkSize);
+        m_readBuffer.resize(used + std::max<qint64>(bytesRead, 0));
+        if (bytesRead <= 0) {
+            break;
+        }
+    }
+
+    m_idleTimer->stop();
+    processNextRequest();
+}
+
+void HttpConnection::onBytesWritten(qint64 bytes)
+{
+    if (!m_streaming) {
+        return;
+    }
+
+    countSent(bytes);
+
+    if (m_isGrowing) {
+        pumpGrowingFile();
+    } else {
+        pumpFile();
+    }
+}
+
+void HttpConnection::onDisconnected()
+{
+    if (m_streaming) {
+        qDebug() << "HttpConnection: Client disconnected with" << m_remaining << "bytes left to send";
+    }
+
+    m_streaming = false;
+    m_file.close();
+    m_isGrowing  = nullptr;
+    m_readStream = nullptr;
+    stopRateMeasurement(false);
+    if (m_writeNotifier) {
+        m_writeNotifier->setEnabled(false);
+    }
+    if (m_growthTimer) {
+        m_growthTimer->stop();
+    }
+
+    emit closed(this);
+    deleteLater();
+}
+
+void HttpConnection::onSocketWritable()
+{
+    m_writeNotifier->setEnabled(false);
+    if (m_streaming) {
+        pumpFile();
+    }
+}
+
+void HttpConnection::processNextRequest()
+{
+    // Pipelined requests wait until the current response is complete
+    if (m_busy || m_socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+
+    qsizetype consumed = 0;
+    const HttpRequestParser::Status status = m_parser.feed(m_readBuffer.constData() + m_readOffset,
+                                                           m_readBuffer.size() - m_readOffset, consumed);
+    m_readOffset += consumed;
+    if (m_readOffset == m_readBuffer.size()) {
+        // Keeps the allocation for the next read
+        m_readBuffer.resize(0);
+        m_readOffset = 0;
+    }
+
+    switch (status) {
+        case HttpRequestParser::Status::Incomplete:
+            m_idleTimer->start();
+            return;
+        case HttpRequestParser::Status::Error:
+            sendError(m_parser.errorStatus());
+            return;
+        case HttpRequestParser::Status::Complete:
+            break;
+    }
+
+    const HttpRequest& request = m_parser.request();
+
+    ++m_requestCount;
+    m_keepAlive = request.keepAlive() && m_requestCount < MaxRequestsPerConnection;
+    m_headRequest = request.isHead();
+    m_http11 = request.minorVersion() >= 1;
+    m_busy = true;
+
+    emit requestReceived(this, request);
+}
+
+void HttpConnection::sendError(int status)
+{
+    QByteArray reason;
+    switch (status) {
+        case 400:
+            reason = "Bad Request";
+            break;
+        case 431:
+            reason = "Request Header Fields Too Large";
+            break;
+        case 501:
+            reason = "Not Implemented";
+            break;
+        case 505:
+            reason = "HTTP Version Not Supported";
+            break;
+        default:
+            reason = "Error";
+            break;
+    }
+
+    qWarning() << "HttpConnection: Rejecting request from" << m_socket->peerAddress().toString() << "with" << status
+               << reason;
+
+    // The stream can't be resynchronised after a malformed request
+    m_keepAlive = false;
+    m_busy = true;
+    sendResponse("HTTP/1.1 " + QByteArray::number(status) + " " + reason
+                 + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+}
+
+void HttpConnection::pumpFile()
+{
+    while (m_streaming) {
+        if (m_remaining == 0) {
+            if (m_nextRange == m_ranges.size()) {
+                finishStream();
+                return;
+            }
+            startRange(m_ranges[m_nextRange++]);
+            continue;
+        }
+
+        if (m_mode == TransferMode::SendFile) {
+            // The header (or a part prefix) must leave Qt's buffer before we
+            // write to the descriptor directly, or the bytes would interleave
+            if (m_socket->bytesToWrite() > 0) {
+                return;
+            }
+
+            switch (sendFileZeroCopy()) {
+                case ZeroCopyResult::RangeDone:
+                    continue;
+                case ZeroCopyResult::Waiting:
+                case ZeroCopyResult::Failed:
+                    return;
+                case ZeroCopyResult::Unsupported:
+                    // Continue with the copy loop from wherever sendfile() got to
+                    if (!m_file.seek(m_offset)) {
+                        qWarning() << "HttpConnection: Failed to seek to" << m_offset << "in" << m_file.fileName();
+                        abortStream();
+                        return;
+                    }
+                    m_mode = TransferMode::Copy;
+                    break;
+            }
+        }
+
+        if (!fillSocketBuffer()) {
+            return;
+        }
+    }
+}
+
+void HttpConnection::pumpGrowingFile()
+{
+    if (m_idleSince >= 0) {
+        m_rateIdleMs += m_rateTimer.elapsed() - m_idleSince;
+        m_idleSince = -1;
+    }
+
+    while (m_streaming && m_socket->bytesToWrite() < HighWaterMark) {
+        // Sample the writer's state before reading, so data written just
+        // before it finished is still picked up by this read
+        const bool growing = m_isGrowing();
+
+        if (m_chunk.size() < ChunkSize) {
+            m_chunk.resize(ChunkSize);
+        }
+        const qint64 bytesRead = m_readStream ? m_readStream(m_chunk.data(), ChunkSize)
+                                              : m_file.read(m_chunk.data(), ChunkSize);
+        if (bytesRead < 0) {
+            qWarning() << "HttpConnection: Read failed on growing stream" << m_file.fileName() << "after" << m_length
+                       << "bytes, aborting";
+            abortStream();
+            return;
+        }
+
+        if (bytesRead > 0) {
+            if (m_chunked) {
+                m_socket->write(QByteArray::number(bytesRead, 16) + "\r\n");
+            }
+            m_socket->write(m_chunk.constData(), bytesRead);
+            if (m_chunked) {
+                m_socket->write("\r\n", 2);
+            }
+            m_length += bytesRead;
+            continue;
+        }
+
+        if (growing) {
+            // Caught up with the writer; once the socket has drained, the
+            // wait is the writer's and not the link's
+            if (m_rateBytes >= 0 && m_socket->bytesToWrite() == 0) {
+                m_idleSince = m_rateTimer.elapsed();
+            }
+            m_growthTimer->start();
+            return;
+        }
+
+        if (m_chunked) {
+            m_socket->write("0\r\n\r\n", 5);
+        }
+        m_isGrowing  = nullptr;
+        m_readStream = nullptr;
+        finishStream();
+        return;
+    }
+
+    // Otherwise wait for bytesWritten() to drain the buffer
+}
+
+void HttpConnection::startRange(const FileRange& range)
+{
+    if (!range.prefix.isEmpty()) {
+        m_socket->write(range.prefix);
+    }
+
+    m_offset = range.offset;
+    m_remaining = range.length;
+
+    if (m_mode == TransferMode::Copy && m_remaining > 0 && !m_file.seek(m_offset)) {
+        qWarning() << "HttpConnection: Failed to seek to" << m_offset << "in" << m_file.fileName();
+        abortStream();
+    }
+}
+
+bool HttpConnection::fillSocketBuffer()
+{
+    while (m_remaining > 0 && m_socket->bytesToWrite() < HighWaterMark) {
+        const qint64 toRead = std::min({ChunkSize, m_remaining, HighWaterMark - m_socket->bytesToWrite()});
+        if (m_chunk.size() < toRead) {
+            m_chunk.resize(ChunkSize);
+        }
+
+        const qint64 bytesRead = m_file.read(m_chunk.data(), toRead);
+        if (bytesRead <= 0) {
+            qWarning() << "HttpConnection: Read failed on" << m_file.fileName() << "with" << m_remaining
+                       << "bytes left, aborting";
+            abortStream();
+            return false;
+        }
+
+        m_socket->write(m_chunk.constData(), bytesRead);
+        m_offset += bytesRead;
+        m_remaining -= bytesRead;
+    }
+
+    // Otherwise wait for bytesWritten() to drain the buffer
+    return m_remaining == 0;
+}
+
+HttpConnection::ZeroCopyResult HttpConnection::sendFileZeroCopy()
+{
+#ifdef Q_OS_LINUX
+    const int socketFd = static_cast<int>(m_socket->socketDescriptor());
+    const int fileFd = m_file.handle();
+    qint64 burst = SendFileBurst;
+
+    while (m_remaining > 0 && burst > 0) {
+        off_t offset = static_cast<off_t>(m_offset);
+        const auto count = static_cast<size_t>(std::min(m_remaining, burst));
+        const ssize_t sent = ::sendfile(socketFd, fileFd, &offset, count);
+
+        if (sent > 0) {
+            m_offset += sent;
+            m_remaining -= sent;
+            burst -= sent;
+            m_zeroCopyStarted = true;
+            countSent(sent);
+            continue;
+        }
+
+        if (sent == 0) {
+            // File shrank underneath us
+            qWarning() << "HttpConnection: Unexpected end of file" << m_file.fileName() << "with" << m_remaining
+                       << "bytes left, aborting";
+            abortStream();
+            return ZeroCopyResult::Failed;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+
+        if ((errno == EINVAL || errno == ENOSYS) && !m_zeroCopyStarted) {
+            qDebug() << "HttpConnection: sendfile() not supported for" << m_file.fileName()
+                     << "- falling back to copy";
+            return ZeroCopyResult::Unsupported;
+        }
+
+        qWarning() << "HttpConnection: sendfile() failed for" << m_file.fileName() << ":" << qt_error_string(errno);
+        abortStream();
+        return ZeroCopyResult::Failed;
+    }
+
+    if (m_remaining == 0) {
+        return ZeroCopyResult::RangeDone;
+    }
+
+    // Kernel send buffer is full (or the burst is used up) - wait until the
+    // socket becomes writable again
+    if (!m_writeNotifier) {
+        m_writeNotifier = new QSocketNotifier(m_socket->socketDescriptor(), QSocketNotifier::Write, this);
+        connect(m_writeNotifier, &QSocketNotifier::activated, this, &HttpConnection::onSocketWritable);
+    }
+    m_writeNotifier->setEnabled(true);
+
+    return ZeroCopyResult::Waiting;
+#else
+    return ZeroCopyResult::Unsupported;
+#endif
+}
+
+void HttpConnection::abortStream()
+{
+    // Content-Length has already been promised, so the only honest thing left
+    // to do is drop the connection
+    m_streaming = false;
+    m_file.close();
+    m_ranges.clear();
+    m_isGrowing  = nullptr;
+    m_readStream = nullptr;
+    if (m_growthTimer) {
+        m_growthTimer->stop();
+    }
+    stopRateMeasurement(false);
+    m_socket->abort();
+}
+
+void HttpConnection::finishStream()
+{
+    m_streaming = false;
+    m_file.close();
+    m_ranges.clear();
+
+    if (!m_trailer.isEmpty()) {
+        m_socket->write(m_trailer);
+        m_trailer.clear();
+    }
+
+    qDebug() << "HttpConnection: Sent" << m_length << "bytes to" << m_socket->peerAddress().toString() << "via"
+             << (m_mode == TransferMode::SendFile ? "sendfile" : "copy");
+    emit fileSent(m_mode, m_length);
+    stopRateMeasurement(true);
+
+    finishResponse();
+}
+
+void HttpConnection::startRateMeasurement()
+{
+    if (!m_stallTimer) {
+        m_stallTimer = new QTimer(this);
+        m_stallTimer->setSingleShot(true);
+        m_stallTimer->setInterval(StallTimeoutMs);
+        connect(m_stallTimer, &QTimer::timeout, this, &HttpConnection::onStallTimeout);
+    }
+
+    m_rateTimer.start();
+    m_rateBytes  = 0;
+    m_rateIdleMs = 0;
+    m_idleSince  = -1;
+    m_stallTimer->start();
+}
+
+void HttpConnection::countSent(qint64 bytes)
+{
+    if (m_rateBytes < 0) {
+        return;
+    }
+
+    m_rateBytes += bytes;
+    m_stallTimer->start();
+
+    if (m_rateBytes >= RateWindowBytes) {
+        stopRateMeasurement(true);
+    }
+}
+
+void HttpConnection::stopRateMeasurement(bool report)
+{
+    if (m_rateBytes < 0) {
+        return;
+    }
+
+    const qint64 bytes = m_rateBytes;
+    const qint64 elapsed = m_rateTimer.elapsed() - m_rateIdleMs;
+    m_rateBytes = -1;
+    m_idleSince = -1;
+    m_stallTimer->stop();
+
+    if (report && bytes >= RateMinBytes && elapsed > 0) {
+        emit sendRateMeasured(bytes, elapsed);
+    }
+}
+
+void HttpConnection::onStallTimeout()
+{
+    if (!m_streaming || m_rateBytes < 0) {
+        return;
+    }
+
+    // Waiting for a growing stream's writer isn't the link's fault
+    const bool pending = m_socket->bytesToWrite() > 0 || (m_writeNotifier && m_writeNotifier->isEnabled());
+    if (!pending) {
+        m_stallTimer->start();
+        return;
+    }
+
+    qDebug() << "HttpConnection: Nothing drained to" << m_socket->peerAddress().toString() << "for"
+             << StallTimeoutMs << "ms";
+    stopRateMeasurement(false);
+    emit sendStalled();
+}
+
+void HttpConnection::finishResponse()
+{
+    m_busy = false;
+
+    if (!m_keepAlive) {
+        // disconnectFromHost() waits for pending data to be written before
+        // closing the socket
+        m_socket->disconnectFromHost();
+        return;
+    }
+
+    // Queued rather than called directly so a burst of pipelined requests
+    // doesn't recurse through the response handlers
+    if (m_readBuffer.isEmpty()) {
+        m_idleTimer->start();
+    } else {
+        QMetaObject::invokeMethod(this, &HttpConnection::processNextRequest, Qt::QueuedConnection);
+    }
+}
+
+} // namespace Chromecast
@@ -0,0 +1,203 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "httprequest.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHostAddress>
+#include <QTcpSocket>
+
+#include <functional>
+#include <vector>
+
+class QSocketNotifier;
+class QTimer;
+
+namespace Chromecast {
+
+/*!
+ * HttpConnection owns a single client socket of the embedded HTTP server.
+ *
+ * File bodies are streamed with backpressure: the socket's write buffer is
+ * only refilled from disk when bytesWritten() reports that it has drained
+ * below the high-water mark, so memory per client stays bounded and the
+ * event loop is never blocked waiting for a slow receiver.
+ *
+ * On Linux, regular files are handed to the kernel with sendfile() so the
+ * body never passes through user space. Anything sendfile() refuses falls
+ * back to the buffered copy loop.
+ *
+ * Files that are still being written (a transcode in progress) are streamed
+ * with chunked transfer encoding as they grow, polling for new data at EOF
+ * until the writer reports that the file is complete. Streams produced in
+ * memory (live audio) are sent the same way.
+ *
+ * Connections are persistent (HTTP/1.1 keep-alive). Pipelined requests are
+ * buffered and answered strictly in order, one response at a time; idle
+ * connections are closed after a timeout and every connection is closed
+ * after a fixed number of requests.
+ *
+ * The start of each body, while the receiver fills its buffer as fast as
+ * the network allows, is timed to estimate the link's throughput. Time a
+ * growing stream spends waiting for its writer doesn't count; a phase
+ * where nothing drains at all is reported as a stall.
+ */
+class HttpConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class TransferMode
+    {
+        Copy,    // File -> QByteArray -> socket buffer
+        SendFile // File -> socket inside the kernel
+    };
+    Q_ENUM(TransferMode)
+
+    // One part of a file response: prefix bytes followed by a byte range of the file
+    struct FileRange
+    {
+        QByteArray prefix;
+        qint64 offset{0};
+        qint64 length{0};
+    };
+
+    explicit HttpConnection(QTcpSocket* socket, QObject* parent = nullptr);
+    ~HttpConnection() override;
+
+    QTcpSocket* socket() const;
+    QHostAddress peerAddress() const;
+    bool isStreaming() const;
+
+    // Whether the connection stays open after the current response
+    bool keepAlive() const;
+    // "Connection: ..." header line(s) for the current response, with CRLF
+    QByteArray connectionHeader() const;
+
+    // Queue a complete in-memory response (header + optional body).
+    // Bodies are dropped for HEAD requests.
+    void sendResponse(const QByteArray& header, const QByteArray& body = {});
+    // Send header, then stream [offset, offset + length) of filePath.
+    // Returns false (and writes nothing) if the file cannot be opened.
+    bool sendFile(const QByteArray& header, const QString& filePath, qint64 offset, qint64 length);
+    // Send header, then each range in order followed by trailer (multipart responses)
+    bool sendFile(const QByteArray& header, const QString& filePath, std::vector<FileRange> ranges,
+                  const QByteArray& trailer = {});
+    // Stream filePath from the start while isGrowing() returns true, then to
+    // its end. header is the status line and entity headers only; the
+    // framing and Connection headers and the blank line are appended here.
+    // HTTP/1.0 clients get a close-delimited body instead of chunks.
+    bool sendGrowingFile(const QByteArray& header, const QString& filePath, std::function<bool()> isGrowing);
+    // Same for data produced in memory: read() copies up to maxSize bytes
+    // and returns how many, 0 when it has nothing new, or -1 on error
+    bool sendStream(const QByteArray& header, std::function<qint64(char* data, qint64 maxSize)> read,
+                    std::function<bool()> isGrowing);
+
+signals:
+    // The request is only valid until the handler returns
+    void requestReceived(Chromecast::HttpConnection* connection, const Chromecast::HttpRequest& request);
+    void closed(Chromecast::HttpConnection* connection);
+    void fileSent(Chromecast::HttpConnection::TransferMode mode, qint64 bytes);
+    // Bytes drained in the given time at the start of a response
+    void sendRateMeasured(qint64 bytes, qint64 milliseconds);
+    // Nothing drained for a while at the start of a response
+    void sendStalled();
+
+private slots:
+    void onReadyRead();
+    void onBytesWritten(qint64 bytes);
+    void onDisconnected();
+    void onSocketWritable();
+    void processNextRequest();
+
+private:
+    void sendError(int status);
+
+    enum class ZeroCopyResult
+    {
+        RangeDone,   // Current range fully handed to the kernel
+        Waiting,     // Send buffer full, resumes from the write notifier
+        Unsupported, // sendfile() refused this file
+        Failed       // Stream aborted
+    };
+
+    void pumpFile();
+    void startGrowingStream(const QByteArray& header);
+    void pumpGrowingFile();
+    void startRange(const FileRange& range);
+    bool fillSocketBuffer();
+    ZeroCopyResult sendFileZeroCopy();
+    void abortStream();
+    void finishStream();
+    void startRateMeasurement();
+    void countSent(qint64 bytes);
+    // Report the rate so far if report is set and enough was sent, then stop
+    void stopRateMeasurement(bool report);
+    void onStallTimeout();
+    void finishResponse();
+
+    QTcpSocket* m_socket{nullptr};
+    QTimer* m_idleTimer{nullptr};
+
+    // Request state
+    HttpRequestParser m_parser;
+    QByteArray m_readBuffer;  // Received bytes not yet fed to the parser
+    qsizetype m_readOffset{0};
+    int m_requestCount{0};
+    bool m_busy{false};       // A request is being answered
+    bool m_keepAlive{false};
+    bool m_headRequest{false};
+    bool m_http11{false};
+
+    // Streaming state for the response currently being sent
+    QFile m_file;
+    QByteArray m_chunk;     // Reused read buffer
+    std::vector<FileRange> m_ranges;
+    size_t m_nextRange{0};
+    QByteArray m_trailer;
+    qint64 m_offset{0};     // Next file offset to send
+    qint64 m_remaining{0};  // Bytes of the current range not yet handed to the socket
+    qint64 m_length{0};     // Total file bytes in the current response
+    TransferMode m_mode{TransferMode::Copy};
+    bool m_zeroCopyStarted{false};
+    bool m_streaming{false};
+
+    // Growing file state, m_isGrowing is empty for regular files
+    std::function<bool()> m_isGrowing;
+    std::function<qint64(char*, qint64)> m_readStream; // Source of a sendStream(), else m_file
+    bool m_chunked{false};
+    QTimer* m_growthTimer{nullptr};
+
+    // Only enabled while sendfile() is waiting for the kernel send buffer
+    QSocketNotifier* m_writeNotifier{nullptr};
+
+    // Send rate at the start of the current response
+    QElapsedTimer m_rateTimer;
+    qint64 m_rateBytes{-1};  // Drained so far, -1 when not measuring
+    qint64 m_rateIdleMs{0};  // Waiting for a growing stream's writer
+    qint64 m_idleSince{-1};  // m_rateTimer time the current wait began
+    QTimer* m_stallTimer{nullptr};
+};
+
+} // namespace Chromecast
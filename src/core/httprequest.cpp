@@ -0,0 +1,373 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "httprequest.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// Upper bound on header fields per request
+constexpr qsizetype MaxHeaderCount = 64;
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+bool equalsIgnoreCase(QByteArrayView a, QByteArrayView b)
+{
+    return a.size() == b.size() && qstrnicmp(a.data(), a.size(), b.data(), b.size()) == 0;
+}
+
+QByteArrayView trimmed(QByteArrayView value)
+{
+    qsizetype begin = 0;
+    qsizetype end = value.size();
+    while (begin < end && isWhitespace(value[begin])) {
+        ++begin;
+    }
+    while (end > begin && isWhitespace(value[end - 1])) {
+        --end;
+    }
+    return value.sliced(begin, end - begin);
+}
+
+// True if the comma-separated list contains token (case-insensitive)
+bool containsToken(QByteArrayView list, QByteArrayView token)
+{
+    qsizetype begin = 0;
+    while (begin <= list.size()) {
+        qsizetype end = begin;
+        while (end < list.size() && list[end] != ',') {
+            ++end;
+        }
+        if (equalsIgnoreCase(trimmed(list.sliced(begin, end - begin)), token)) {
+            return true;
+        }
+        begin = end + 1;
+    }
+    return false;
+}
+
+// Parse a non-negative decimal number, -1 on failure or overflow
+qint64 parseDecimal(QByteArrayView value)
+{
+    if (value.isEmpty() || value.size() > 18) {
+        return -1;
+    }
+
+    qint64 result = 0;
+    for (const char c : value) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        result = result * 10 + (c - '0');
+    }
+    return result;
+}
+} // namespace
+
+namespace Chromecast {
+
+QByteArrayView HttpRequest::method() const
+{
+    return view(m_method);
+}
+
+QByteArrayView HttpRequest::target() const
+{
+    return view(m_target);
+}
+
+QByteArrayView HttpRequest::path() const
+{
+    const QByteArrayView fullTarget = target();
+    const auto* query = static_cast<const char*>(std::memchr(fullTarget.data(), '?', static_cast<size_t>(fullTarget.size())));
+    return query ? fullTarget.first(query - fullTarget.data()) : fullTarget;
+}
+
+int HttpRequest::minorVersion() const
+{
+    return m_minorVersion;
+}
+
+QByteArrayView HttpRequest::header(QByteArrayView name) const
+{
+    for (qsizetype i = 0; i < m_headerCount; ++i) {
+        const Header& field = m_headers[static_cast<size_t>(i)];
+        if (equalsIgnoreCase(view(field.name), name)) {
+            return view(field.value);
+        }
+    }
+    return {};
+}
+
+bool HttpRequest::hasHeader(QByteArrayView name) const
+{
+    for (qsizetype i = 0; i < m_headerCount; ++i) {
+        if (equalsIgnoreCase(view(m_headers[static_cast<size_t>(i)].name), name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HttpRequest::isHead() const
+{
+    return equalsIgnoreCase(method(), "HEAD");
+}
+
+bool HttpRequest::keepAlive() const
+{
+    // HTTP/1.1 is persistent unless the client opts out, HTTP/1.0 only if it opts in
+    const QByteArrayView connection = header("connection");
+    if (m_minorVersion >= 1) {
+        return !containsToken(connection, "close");
+    }
+    return containsToken(connection, "keep-alive");
+}
+
+QByteArrayView HttpRequest::view(Span span) const
+{
+    return {m_raw.constData() + span.offset, span.length};
+}
+
+void HttpRequest::clear()
+{
+    // resize() rather than clear() keeps the allocation for the next request
+    m_raw.resize(0);
+    m_method = {};
+    m_target = {};
+    m_minorVersion = 1;
+    m_headerCount = 0;
+}
+
+HttpRequestParser::HttpRequestParser(qsizetype maxHeaderBytes)
+    : m_maxHeaderBytes(maxHeaderBytes)
+{
+    m_request.m_raw.reserve(1024);
+}
+
+HttpRequestParser::Status HttpRequestParser::feed(const char* data, qsizetype size, qsizetype& consumed)
+{
+    consumed = 0;
+
+    if (m_state == State::Failed) {
+        return Status::Error;
+    }
+    if (m_state == State::Done) {
+        reset();
+    }
+
+    while (consumed < size) {
+        if (m_state == State::Body) {
+            // None of our handlers take a request body - skip it
+            const auto skip = static_cast<qsizetype>(std::min<qint64>(m_bodyRemaining, size - consumed));
+            consumed += skip;
+            m_bodyRemaining -= skip;
+            if (m_bodyRemaining == 0) {
+                m_state = State::Done;
+                return Status::Complete;
+            }
+            continue;
+        }
+
+        const char* begin = data + consumed;
+        const qsizetype available = size - consumed;
+        const auto* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(available)));
+        const qsizetype take = newline ? (newline - begin) + 1 : available;
+
+        if (m_request.m_raw.size() + take > m_maxHeaderBytes) {
+            return fail(431);
+        }
+
+        m_request.m_raw.append(begin, take);
+        consumed += take;
+
+        if (!newline) {
+            return Status::Incomplete;
+        }
+
+        // Line without its CRLF (a bare LF is tolerated)
+        const qsizetype lineStart = m_lineStart;
+        qsizetype lineEnd = m_request.m_raw.size() - 1;
+        if (lineEnd > lineStart && m_request.m_raw.at(lineEnd - 1) == '\r') {
+            --lineEnd;
+        }
+        m_lineStart = m_request.m_raw.size();
+
+        if (!processLine(lineStart, lineEnd)) {
+            return Status::Error;
+        }
+        if (m_state == State::Done) {
+            return Status::Complete;
+        }
+    }
+
+    return m_state == State::Done ? Status::Complete : Status::Incomplete;
+}
+
+const HttpRequest& HttpRequestParser::request() const
+{
+    return m_request;
+}
+
+int HttpRequestParser::errorStatus() const
+{
+    return m_errorStatus;
+}
+
+void HttpRequestParser::reset()
+{
+    m_request.clear();
+    m_state = State::RequestLine;
+    m_lineStart = 0;
+    m_bodyRemaining = 0;
+    m_errorStatus = 0;
+}
+
+bool HttpRequestParser::processLine(qsizetype start, qsizetype end)
+{
+    switch (m_state) {
+        case State::RequestLine:
+            // Empty lines before the request line are allowed (RFC 7230 3.5)
+            if (start == end) {
+                return true;
+            }
+            return parseRequestLine(start, end);
+        case State::Headers:
+            if (start == end) {
+                return finishHeaders();
+            }
+            return parseHeaderLine(start, end);
+        default:
+            return true;
+    }
+}
+
+bool HttpRequestParser::parseRequestLine(qsizetype start, qsizetype end)
+{
+    // METHOD SP request-target SP HTTP/1.x
+    const char* raw = m_request.m_raw.constData();
+    const auto* firstSpace = static_cast<const char*>(std::memchr(raw + start, ' ', static_cast<size_t>(end - start)));
+    if (!firstSpace || firstSpace == raw + start) {
+        fail(400);
+        return false;
+    }
+
+    const qsizetype targetStart = (firstSpace - raw) + 1;
+    const auto* secondSpace
+        = static_cast<const char*>(std::memchr(raw + targetStart, ' ', static_cast<size_t>(end - targetStart)));
+    if (!secondSpace || secondSpace == raw + targetStart) {
+        fail(400);
+        return false;
+    }
+
+    const qsizetype versionStart = (secondSpace - raw) + 1;
+    const QByteArrayView version(raw + versionStart, end - versionStart);
+    if (version.size() != 8 || !version.startsWith("HTTP/")) {
+        fail(400);
+        return false;
+    }
+    if (version[5] != '1' || version[6] != '.' || version[7] < '0' || version[7] > '9') {
+        fail(505);
+        return false;
+    }
+
+    m_request.m_method = {start, (firstSpace - raw) - start};
+    m_request.m_target = {targetStart, (secondSpace - raw) - targetStart};
+    m_request.m_minorVersion = version[7] - '0';
+    m_state = State::Headers;
+
+    return true;
+}
+
+bool HttpRequestParser::parseHeaderLine(qsizetype start, qsizetype end)
+{
+    const char* raw = m_request.m_raw.constData();
+
+    // Obsolete line folding is rejected (RFC 7230 3.2.4)
+    if (isWhitespace(raw[start])) {
+        fail(400);
+        return false;
+    }
+
+    const auto* colon = static_cast<const char*>(std::memchr(raw + start, ':', static_cast<size_t>(end - start)));
+    if (!colon || colon == raw + start || isWhitespace(*(colon - 1))) {
+        fail(400);
+        return false;
+    }
+
+    if (m_request.m_headerCount >= MaxHeaderCount) {
+        fail(431);
+        return false;
+    }
+
+    qsizetype valueStart = (colon - raw) + 1;
+    qsizetype valueEnd = end;
+    while (valueStart < valueEnd && isWhitespace(raw[valueStart])) {
+        ++valueStart;
+    }
+    while (valueEnd > valueStart && isWhitespace(raw[valueEnd - 1])) {
+        --valueEnd;
+    }
+
+    auto& headers = m_request.m_headers;
+    if (m_request.m_headerCount == static_cast<qsizetype>(headers.size())) {
+        headers.emplace_back();
+    }
+
+    HttpRequest::Header& field = headers[static_cast<size_t>(m_request.m_headerCount++)];
+    field.name = {start, (colon - raw) - start};
+    field.value = {valueStart, valueEnd - valueStart};
+
+    return true;
+}
+
+bool HttpRequestParser::finishHeaders()
+{
+    if (m_request.hasHeader("transfer-encoding")) {
+        fail(501);
+        return false;
+    }
+
+    qint64 contentLength = 0;
+    if (m_request.hasHeader("content-length")) {
+        contentLength = parseDecimal(m_request.header("content-length"));
+        if (contentLength < 0) {
+            fail(400);
+            return false;
+        }
+    }
+
+    m_bodyRemaining = contentLength;
+    m_state = contentLength > 0 ? State::Body : State::Done;
+
+    return true;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status)
+{
+    m_state = State::Failed;
+    m_errorStatus = status;
+    return Status::Error;
+}
+
+} // namespace Chromecast
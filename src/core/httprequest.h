@@ -0,0 +1,132 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <vector>
+
+namespace Chromecast {
+
+/*!
+ * A parsed HTTP request header block.
+ *
+ * All fields are views into one raw buffer owned by the request, so parsing
+ * a request does not allocate once the buffer has grown to a typical header
+ * size. Views are only valid until the parser that filled the request is
+ * fed again.
+ */
+class HttpRequest
+{
+public:
+    [[nodiscard]] QByteArrayView method() const;
+    [[nodiscard]] QByteArrayView target() const;
+    // Request target without query string
+    [[nodiscard]] QByteArrayView path() const;
+    [[nodiscard]] int minorVersion() const;
+
+    // Header lookup is case-insensitive. Returns an empty view if missing.
+    [[nodiscard]] QByteArrayView header(QByteArrayView name) const;
+    [[nodiscard]] bool hasHeader(QByteArrayView name) const;
+
+    [[nodiscard]] bool isHead() const;
+    [[nodiscard]] bool keepAlive() const;
+
+private:
+    friend class HttpRequestParser;
+
+    struct Span
+    {
+        qsizetype offset{0};
+        qsizetype length{0};
+    };
+
+    struct Header
+    {
+        Span name;
+        Span value;
+    };
+
+    [[nodiscard]] QByteArrayView view(Span span) const;
+    void clear();
+
+    QByteArray m_raw;
+    Span m_method;
+    Span m_target;
+    int m_minorVersion{1};
+    std::vector<Header> m_headers;
+    qsizetype m_headerCount{0}; // m_headers is reused, only the first m_headerCount are valid
+};
+
+/*!
+ * Incremental HTTP/1.x request parser.
+ *
+ * Bytes can be fed in arbitrary pieces as they arrive from the socket; the
+ * parser keeps its state between calls and reports a request once its
+ * header block is complete. The total header size is bounded.
+ */
+class HttpRequestParser
+{
+public:
+    enum class Status
+    {
+        Incomplete,
+        Complete,
+        Error
+    };
+
+    explicit HttpRequestParser(qsizetype maxHeaderBytes = 16 * 1024);
+
+    // Consume bytes from data. consumed is set to the number of bytes used;
+    // anything after a complete request belongs to the next one.
+    Status feed(const char* data, qsizetype size, qsizetype& consumed);
+
+    [[nodiscard]] const HttpRequest& request() const;
+    // HTTP status code to answer a malformed request with
+    [[nodiscard]] int errorStatus() const;
+
+    void reset();
+
+private:
+    enum class State
+    {
+        RequestLine,
+        Headers,
+        Body,
+        Done,
+        Failed
+    };
+
+    bool processLine(qsizetype start, qsizetype end);
+    bool parseRequestLine(qsizetype start, qsizetype end);
+    bool parseHeaderLine(qsizetype start, qsizetype end);
+    bool finishHeaders();
+    Status fail(int status);
+
+    HttpRequest m_request;
+    State m_state{State::RequestLine};
+    qsizetype m_maxHeaderBytes;
+    qsizetype m_lineStart{0};
+    qint64 m_bodyRemaining{0};
+    int m_errorStatus{0};
+};
+
+} // namespace Chromecast
@@ -26,17 +26,170 @@
 #include <QFileInfo>
 #include <QUrl>
 #include <QDebug>
-#include <QCryptographicHash>
+#include <QNetworkInformation>
 #include <QNetworkInterface>
+#include <QBuffer>
+#include <QImage>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Hands accepted descriptors straight to the server instead of queueing
+// QTcpSockets, so each socket can be created on its worker thread
+class HttpListener : public QTcpServer
+{
+public:
+    using Handler = std::function<void(qintptr)>;
+
+    HttpListener(Handler handler, QObject* parent)
+        : QTcpServer(parent)
+        , m_handler(std::move(handler))
+    { }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        m_handler(socketDescriptor);
+    }
+
+private:
+    Handler m_handler;
+};
+
+// For an accepted descriptor no socket took over
+void closeDescriptor(qintptr socketDescriptor)
+{
+#ifdef Q_OS_WIN
+    ::closesocket(static_cast<SOCKET>(socketDescriptor));
+#else
+    ::close(static_cast<int>(socketDescriptor));
+#endif
+}
+
+// An accepted descriptor on its way to a worker. Closed unless a socket
+// adopts it, also when the worker goes away before it gets to it.
+class PendingDescriptor
+{
+public:
+    explicit PendingDescriptor(qintptr socketDescriptor)
+        : m_descriptor{socketDescriptor}
+    { }
+
+    ~PendingDescriptor()
+    {
+        if (m_descriptor >= 0) {
+            closeDescriptor(m_descriptor);
+        }
+    }
+
+    PendingDescriptor(const PendingDescriptor&) = delete;
+    PendingDescriptor& operator=(const PendingDescriptor&) = delete;
+
+    [[nodiscard]] qintptr get() const
+    {
+        return m_descriptor;
+    }
+
+    // A socket owns it now
+    void release()
+    {
+        m_descriptor = -1;
+    }
+
+private:
+    qintptr m_descriptor;
+};
+
+// Bridges, tunnels and VM networks a receiver is rarely on
+constexpr std::array VirtualInterfacePrefixes{"docker", "br-", "veth", "virbr", "vboxnet", "vmnet",
+                                              "tun",    "tap", "wg",   "zt",    "utun"};
+
+bool loadNetworkInformation()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    return QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability);
+#else
+    return QNetworkInformation::load(QNetworkInformation::Feature::Reachability);
+#endif
+}
+
+// JPEG quality for downscaled cover art
+constexpr int CoverJpegQuality = 85;
+
+// Upper bound on ranges in one request; more than this is answered with the
+// whole file, as RFC 7233 allows
+constexpr int MaxRanges = 16;
+
+bool parseByteOffset(const QByteArray& value, qint64& result)
+{
+    if (value.isEmpty()) {
+        return false;
+    }
+    for (const char c : value) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    bool ok{false};
+    result = value.toLongLong(&ok);
+    return ok;
+}
+
+bool equals(QByteArrayView a, QByteArrayView b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), static_cast<size_t>(a.size())) == 0;
+}
+
+// True if any entity tag in a comma-separated If-None-Match/If-Range list matches etag
+bool etagListMatches(QByteArrayView list, const QByteArray& etag, bool weakComparison)
+{
+    const QList<QByteArray> tags = list.toByteArray().split(',');
+    for (QByteArray tag : tags) {
+        tag = tag.trimmed();
+        if (tag == "*") {
+            return true;
+        }
+        if (tag.startsWith("W/")) {
+            if (!weakComparison) {
+                continue;
+            }
+            tag = tag.mid(2);
+        }
+        if (tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
 
 namespace Chromecast {
 
 HttpServer::HttpServer(std::shared_ptr<Fooyin::AudioLoader> audioLoader, QObject* parent)
     : QObject(parent)
     , m_audioLoader(std::move(audioLoader))
-    , m_server(new QTcpServer(this))
+    , m_server(new HttpListener([this](qintptr descriptor) { dispatchConnection(descriptor); }, this))
+    , m_workerThreadCount(defaultWorkerThreadCount())
 {
-    connect(m_server, &QTcpServer::newConnection, this, &HttpServer::onNewConnection);
+    // Interfaces coming and going (Wi-Fi roaming, VPN up/down) change which address receivers can reach
+    if (loadNetworkInformation()) {
+        connect(QNetworkInformation::instance(), &QNetworkInformation::reachabilityChanged, this,
+                &HttpServer::refreshAddresses);
+    }
 }
 
 HttpServer::~HttpServer()
@@ -44,6 +197,21 @@ HttpServer::~HttpServer()
     stop();
 }
 
+void HttpServer::setWorkerThreadCount(int count)
+{
+    m_workerThreadCount = std::max(1, count);
+}
+
+int HttpServer::workerThreadCount() const
+{
+    return m_workerThreadCount;
+}
+
+int HttpServer::defaultWorkerThreadCount()
+{
+    return std::max(1, QThread::idealThreadCount() / 2);
+}
+
 bool HttpServer::start(quint16 port)
 {
     if (m_isRunning) {
@@ -59,12 +227,17 @@ bool HttpServer::start(quint16 port)
         return false;
     }
 
+    startWorkers();
+
     m_isRunning = true;
     m_port = m_server->serverPort(); // Get actual port (useful if port was 0)
 
     qInfo() << "HTTP server started on" << m_server->serverAddress().toString() << ":" << m_port;
     qInfo() << "HTTP server is listening:" << m_server->isListening();
     qInfo() << "HTTP server max pending connections:" << m_server->maxPendingConnections();
+    qInfo() << "HTTP server worker threads:" << m_workers.size();
+
+    refreshAddresses();
 
     return true;
 }
@@ -76,7 +249,15 @@ void HttpServer::stop()
     }
 
     m_server->close();
-    m_mediaFiles.clear();
+    stopWorkers();
+    logDiagnostics();
+    m_registry.clear();
+    {
+        const QMutexLocker locker(&m_growingLock);
+        m_growingFiles.clear();
+        m_liveStreams.clear();
+    }
+    m_coverCache.clear();
     m_isRunning = false;
     qInfo() << "HTTP server stopped";
 }
@@ -98,31 +279,94 @@ quint16 HttpServer::serverPort() const
 
 QString HttpServer::serverUrl() const
 {
-    // Find the first non-localhost IPv4 address
-    // This will be accessible to Chromecast devices on the local network
+    return m_baseUrl;
+}
+
+void HttpServer::setReceiverAddress(const QHostAddress& receiver, const QHostAddress& routeAddress)
+{
+    m_receiverAddress = receiver;
+    m_routeAddress = routeAddress;
+    selectAddress();
+}
+
+void HttpServer::refreshAddresses()
+{
+    m_localAddresses.clear();
+
+    const QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+    for (const QNetworkInterface& iface : interfaces) {
+        const auto flags = iface.flags();
+        if (!flags.testFlag(QNetworkInterface::IsUp) || !flags.testFlag(QNetworkInterface::IsRunning)
+            || flags.testFlag(QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+
+        const bool isVirtual = iface.type() == QNetworkInterface::Virtual
+                            || VirtualInterfacePrefixes.end()
+                                   != std::find_if(VirtualInterfacePrefixes.begin(), VirtualInterfacePrefixes.end(),
+                                                   [&iface](const char* prefix) {
+                                                       return iface.name().startsWith(QLatin1String(prefix));
+                                                   });
+
+        const QList<QNetworkAddressEntry> entries = iface.addressEntries();
+        for (const QNetworkAddressEntry& entry : entries) {
+            // Chromecast uses IPv4
+            if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol) {
+                continue;
+            }
+            // Bridges and tunnels go last so they only win when nothing else matches
+            if (isVirtual) {
+                m_localAddresses.append(entry);
+            } else {
+                m_localAddresses.prepend(entry);
+            }
+        }
+    }
+
+    qDebug() << "HTTP server local addresses:" << m_localAddresses.size();
+    selectAddress();
+}
+
+void HttpServer::selectAddress()
+{
     QHostAddress lanAddress;
 
-    const QList<QHostAddress> addresses = QNetworkInterface::allAddresses();
-    for (const QHostAddress& address : addresses) {
-        // Skip localhost, IPv6, and invalid addresses
-        if (address.protocol() == QAbstractSocket::IPv4Protocol
-            && !address.isLoopback()
-            && address != QHostAddress::LocalHost) {
-            lanAddress = address;
-            break;
+    // The address the kernel already routes to the receiver is always right
+    if (!m_routeAddress.isNull()) {
+        for (const QNetworkAddressEntry& entry : std::as_const(m_localAddresses)) {
+            if (entry.ip().isEqual(m_routeAddress, QHostAddress::ConvertV4MappedToIPv4)) {
+                lanAddress = entry.ip();
+                break;
+            }
         }
     }
 
+    // Otherwise the interface whose subnet contains the receiver
+    if (lanAddress.isNull() && !m_receiverAddress.isNull()) {
+        for (const QNetworkAddressEntry& entry : std::as_const(m_localAddresses)) {
+            if (m_receiverAddress.isInSubnet(entry.ip(), entry.prefixLength())) {
+                lanAddress = entry.ip();
+                break;
+            }
+        }
+    }
+
+    // Receiver unknown or routed: first physical interface
+    if (lanAddress.isNull() && !m_localAddresses.isEmpty()) {
+        lanAddress = m_localAddresses.constFirst().ip();
+    }
+
     // Fallback to localhost if no LAN IP found (shouldn't happen in normal cases)
     if (lanAddress.isNull()) {
         qWarning() << "Could not detect LAN IP address, using localhost (Chromecast won't be able to connect)";
         lanAddress = QHostAddress::LocalHost;
     }
 
-    QString url = QString("http://%1:%2").arg(lanAddress.toString()).arg(m_port);
-    qDebug() << "HTTP server URL:" << url;
-
-    return url;
+    const QString url = QString("http://%1:%2").arg(lanAddress.toString()).arg(m_port);
+    if (url != m_baseUrl) {
+        m_baseUrl = url;
+        qInfo() << "HTTP server URL:" << m_baseUrl;
+    }
 }
 
 QString HttpServer::createMediaUrl(const QString& mediaPath)
@@ -132,16 +376,7 @@ QString HttpServer::createMediaUrl(const QString& mediaPath)
         return QString();
     }
 
-    // Create a unique identifier for this file
-    QByteArray hash = QCryptographicHash::hash(mediaPath.toUtf8(), QCryptographicHash::Md5);
-    QString fileId = QString(hash.toHex().left(16));
-
-    QFileInfo fileInfo(mediaPath);
-    QString extension = fileInfo.suffix();
-    QString urlPath = QString("/media/%1.%2").arg(fileId, extension);
-
-    // Store the mapping
-    m_mediaFiles[urlPath] = mediaPath;
+    const QString urlPath = m_registry.addMedia(mediaPath);
 
     QString url = QString("%1%2").arg(serverUrl(), urlPath);
     qInfo() << "Created media URL:" << url << "for file:" << mediaPath;
@@ -156,13 +391,7 @@ QString HttpServer::createCoverUrl(const QString& mediaPath)
         return QString();
     }
 
-    // Create a unique identifier for this file's cover
-    QByteArray hash = QCryptographicHash::hash(mediaPath.toUtf8(), QCryptographicHash::Md5);
-    QString fileId = QString(hash.toHex().left(16));
-    QString urlPath = QString("/cover/%1.jpg").arg(fileId);
-
-    // Store the mapping (media path, not cover path - we extract cover on demand)
-    m_coverFiles[urlPath] = mediaPath;
+    const QString urlPath = m_registry.addCover(mediaPath);
 
     QString url = QString("%1%2").arg(serverUrl(), urlPath);
     qInfo() << "Created cover URL:" << url << "for media file:" << mediaPath;
@@ -170,233 +399,715 @@ QString HttpServer::createCoverUrl(const QString& mediaPath)
     return url;
 }
 
-void HttpServer::onNewConnection()
+void HttpServer::beginGrowingFile(const QString& filePath, const QString& writePath)
 {
-    qInfo() << "HTTP Server: New connection received";
-    while (m_server->hasPendingConnections()) {
-        QTcpSocket* socket = m_server->nextPendingConnection();
-        qInfo() << "HTTP Server: Accepted connection from" << socket->peerAddress().toString();
-        connect(socket, &QTcpSocket::readyRead, this, &HttpServer::onReadyRead);
-        connect(socket, &QTcpSocket::disconnected, this, &HttpServer::onDisconnected);
+    auto file = std::make_shared<GrowingFile>();
+    file->writePath = writePath.isEmpty() ? filePath : writePath;
+
+    const QMutexLocker locker(&m_growingLock);
+    m_growingFiles.insert(filePath, std::move(file));
+}
+
+void HttpServer::finishGrowingFile(const QString& filePath)
+{
+    const QMutexLocker locker(&m_growingLock);
+    if (const auto file = m_growingFiles.take(filePath)) {
+        file->growing.store(false);
+        qDebug() << "HTTP server: Growing file finished:" << filePath;
     }
 }
 
-void HttpServer::onReadyRead()
+std::shared_ptr<const HttpServer::GrowingFile> HttpServer::growingFile(const QString& filePath) const
 {
-    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) {
-        return;
+    const QMutexLocker locker(&m_growingLock);
+    return m_growingFiles.value(filePath);
+}
+
+QString HttpServer::addLiveStream(std::shared_ptr<LiveStream> stream, const QString& suffix)
+{
+    if (!m_isRunning) {
+        qWarning() << "HTTP server not running";
+        return QString();
+    }
+
+    QString urlPath;
+    {
+        const QMutexLocker locker(&m_growingLock);
+        urlPath = QString("/live/%1.%2").arg(m_nextLiveStream++).arg(suffix);
+        m_liveStreams.insert(urlPath, std::move(stream));
     }
 
-    QString request = QString::fromUtf8(socket->readAll());
-    handleRequest(socket, request);
+    QString url = QString("%1%2").arg(serverUrl(), urlPath);
+    qInfo() << "Created live stream URL:" << url;
+
+    return url;
 }
 
-void HttpServer::onDisconnected()
+void HttpServer::removeLiveStream(const std::shared_ptr<LiveStream>& stream)
 {
-    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
-    if (socket) {
-        socket->deleteLater();
+    // Connections already streaming it keep their reference until the end
+    const QMutexLocker locker(&m_growingLock);
+    for (auto it = m_liveStreams.begin(); it != m_liveStreams.end();) {
+        if (it.value() == stream) {
+            it = m_liveStreams.erase(it);
+        } else {
+            ++it;
+        }
     }
 }
 
-void HttpServer::handleRequest(QTcpSocket* socket, const QString& request)
+void HttpServer::retainMedia(MediaRegistry::Holder holder, const QStringList& mediaPaths)
 {
-    // Parse HTTP request
-    QStringList lines = request.split("\r\n");
-    if (lines.isEmpty()) {
-        send404(socket);
-        return;
+    m_registry.retain(holder, mediaPaths);
+}
+
+MediaRegistry::Stats HttpServer::registryStats() const
+{
+    return m_registry.stats();
+}
+
+LinkMonitor::Link HttpServer::linkStats(const QHostAddress& peer) const
+{
+    return m_links.link(peer);
+}
+
+int HttpServer::sustainableBitrate(const QHostAddress& peer) const
+{
+    return m_links.sustainableBitrate(peer);
+}
+
+void HttpServer::setCoverCacheSize(qint64 bytes)
+{
+    m_coverCache.setMaxBytes(bytes);
+}
+
+void HttpServer::setCoverMaxDimension(int pixels)
+{
+    m_coverMaxDimension.store(std::max(0, pixels));
+}
+
+CoverCache::Stats HttpServer::coverCacheStats() const
+{
+    return m_coverCache.stats();
+}
+
+void HttpServer::logDiagnostics() const
+{
+    const TransferStats transfers = transferStats();
+    qInfo() << "HTTP server transfers: sendfile" << transfers.sendFileResponses << "responses /"
+            << transfers.sendFileBytes << "bytes, copy" << transfers.copyResponses << "responses /"
+            << transfers.copyBytes << "bytes";
+
+    const CoverCache::Stats covers = coverCacheStats();
+    qInfo() << "HTTP server cover cache:" << covers.hits << "hits," << covers.negativeHits << "negative hits,"
+            << covers.misses << "misses," << covers.usedBytes << "/" << covers.maxBytes << "bytes";
+
+    const MediaRegistry::Stats registry = registryStats();
+    qInfo() << "HTTP server media registry:" << registry.entries << "entries (" << registry.retained << "retained,"
+            << registry.pathBytes << "path bytes)," << registry.expired << "expired";
+}
+
+HttpServer::TransferStats HttpServer::transferStats() const
+{
+    TransferStats stats;
+    stats.sendFileResponses = m_sendFileResponses.load(std::memory_order_relaxed);
+    stats.sendFileBytes = m_sendFileBytes.load(std::memory_order_relaxed);
+    stats.copyResponses = m_copyResponses.load(std::memory_order_relaxed);
+    stats.copyBytes = m_copyBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void HttpServer::startWorkers()
+{
+    for (int i = 0; i < m_workerThreadCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->thread = new QThread(this);
+        worker->thread->setObjectName(QString("ChromecastHttp%1").arg(i));
+        worker->context = new QObject();
+        worker->context->moveToThread(worker->thread);
+        connect(worker->thread, &QThread::finished, worker->context, &QObject::deleteLater);
+        worker->thread->start();
+        m_workers.push_back(std::move(worker));
     }
+}
+
+void HttpServer::stopWorkers()
+{
+    for (const auto& worker : m_workers) {
+        // Drop live connections on their own thread before it goes away
+        QMetaObject::invokeMethod(
+            worker->context, [context = worker->context]() { qDeleteAll(context->findChildren<HttpConnection*>()); },
+            Qt::BlockingQueuedConnection);
+        worker->thread->quit();
+        worker->thread->wait();
+        delete worker->thread;
+    }
+    m_workers.clear();
+}
 
-    // Parse first line: GET /path HTTP/1.1
-    QStringList requestLine = lines[0].split(" ");
-    if (requestLine.size() < 2) {
-        send404(socket);
+void HttpServer::dispatchConnection(qintptr socketDescriptor)
+{
+    if (m_workers.empty()) {
+        closeDescriptor(socketDescriptor);
         return;
     }
 
-    QString method = requestLine[0];
-    QString path = requestLine[1];
+    // Least-loaded worker gets the new connection
+    Worker* worker = std::min_element(m_workers.cbegin(), m_workers.cend(), [](const auto& a, const auto& b) {
+                         return a->connections.load() < b->connections.load();
+                     })->get();
+    worker->connections.fetch_add(1);
+
+    // Dropped with the queued call if the worker's context is destroyed
+    // before it runs, e.g. by stop()
+    auto pending = std::make_shared<PendingDescriptor>(socketDescriptor);
+
+    QMetaObject::invokeMethod(
+        worker->context,
+        [this, worker, pending]() {
+            auto* socket = new QTcpSocket();
+            if (!socket->setSocketDescriptor(pending->get())) {
+                qWarning() << "HTTP Server: Failed to adopt socket:" << socket->errorString();
+                delete socket;
+                worker->connections.fetch_sub(1);
+                return;
+            }
+            pending->release();
+
+            qDebug() << "HTTP Server: Accepted connection from" << socket->peerAddress().toString() << "on"
+                     << QThread::currentThread()->objectName();
+
+            auto* connection = new HttpConnection(socket, worker->context);
+            connect(connection, &HttpConnection::requestReceived, this, &HttpServer::handleRequest,
+                    Qt::DirectConnection);
+            connect(connection, &HttpConnection::fileSent, this, &HttpServer::onFileSent, Qt::DirectConnection);
+            connect(
+                connection, &HttpConnection::sendRateMeasured, this,
+                [this, connection](qint64 bytes, qint64 milliseconds) {
+                    const QHostAddress peer = connection->peerAddress();
+                    m_links.addSample(peer, bytes, milliseconds);
+                    emit linkMeasured(peer);
+                },
+                Qt::DirectConnection);
+            connect(
+                connection, &HttpConnection::sendStalled, this,
+                [this, connection]() {
+                    const QHostAddress peer = connection->peerAddress();
+                    m_links.addStall(peer);
+                    emit linkMeasured(peer);
+                },
+                Qt::DirectConnection);
+            connect(connection, &QObject::destroyed, worker->context,
+                    [worker]() { worker->connections.fetch_sub(1); }, Qt::DirectConnection);
+        },
+        Qt::QueuedConnection);
+}
 
-    qInfo() << "HTTP Request:" << method << path;
+void HttpServer::handleRequest(Chromecast::HttpConnection* connection, const Chromecast::HttpRequest& request)
+{
+    const QString path = QString::fromUtf8(request.path());
 
-    // Check for Range header (for seeking support)
-    qint64 rangeStart = -1;
-    qint64 rangeEnd = -1;
-    for (const QString& line : lines) {
-        if (line.startsWith("Range:", Qt::CaseInsensitive)) {
-            // Parse Range: bytes=start-end
-            QString rangeStr = line.mid(6).trimmed();
-            if (rangeStr.startsWith("bytes=")) {
-                QString byteRange = rangeStr.mid(6);
-                QStringList rangeParts = byteRange.split("-");
-                if (rangeParts.size() >= 1 && !rangeParts[0].isEmpty()) {
-                    rangeStart = rangeParts[0].toLongLong();
-                }
-                if (rangeParts.size() >= 2 && !rangeParts[1].isEmpty()) {
-                    rangeEnd = rangeParts[1].toLongLong();
-                }
-            }
-        }
-    }
+    qInfo() << "HTTP Request:" << QString::fromLatin1(request.method()) << path;
 
     // Check if this is a cover request
-    if (m_coverFiles.contains(path)) {
-        QString mediaPath = m_coverFiles[path];
-        serveCover(socket, mediaPath);
+    const QString coverMediaPath = m_registry.coverPath(path);
+    if (!coverMediaPath.isEmpty()) {
+        serveCover(connection, request, coverMediaPath);
+        return;
+    }
+
+    if (path.startsWith(QLatin1String("/live/"))) {
+        std::shared_ptr<LiveStream> stream;
+        {
+            const QMutexLocker locker(&m_growingLock);
+            stream = m_liveStreams.value(path);
+        }
+        if (!stream) {
+            qWarning() << "Live stream not found:" << path;
+            send404(connection);
+            return;
+        }
+        serveLiveStream(connection, path, std::move(stream));
         return;
     }
 
     // Find the file for this path
-    if (!m_mediaFiles.contains(path)) {
+    const QString filePath = m_registry.mediaPath(path);
+    if (filePath.isEmpty()) {
         qWarning() << "File not found for path:" << path;
-        send404(socket);
+        send404(connection);
         return;
     }
 
-    QString filePath = m_mediaFiles[path];
-    serveFile(socket, filePath, rangeStart, rangeEnd);
+    serveFile(connection, request, filePath);
 }
 
-void HttpServer::serveFile(QTcpSocket* socket, const QString& filePath, qint64 start, qint64 end)
+void HttpServer::serveFile(HttpConnection* connection, const HttpRequest& request, const QString& filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open file:" << filePath;
-        send404(socket);
+    // Length and validators aren't known until the writer finishes
+    if (auto growing = growingFile(filePath)) {
+        serveGrowingFile(connection, filePath, std::move(growing));
         return;
     }
 
-    qint64 fileSize = file.size();
-    QString mimeType = getMimeType(filePath);
-
-    // Handle range request
-    if (start >= 0) {
-        if (end < 0 || end >= fileSize) {
-            end = fileSize - 1;
-        }
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.isFile() || !fileInfo.isReadable()) {
+        qWarning() << "Failed to open file:" << filePath;
+        send404(connection);
+        return;
+    }
 
-        qint64 contentLength = end - start + 1;
+    const qint64 fileSize = fileInfo.size();
+    const QString mimeType = getMimeType(filePath);
+    const QByteArray etag = entityTag(fileSize, fileInfo.lastModified());
+    const QByteArray lastModified = httpDate(fileInfo.lastModified());
+    const QString validators = QString("ETag: %1\r\nLast-Modified: %2\r\n")
+                                   .arg(QString::fromLatin1(etag), QString::fromLatin1(lastModified));
+    const QString connectionHeader = QString::fromLatin1(connection->connectionHeader());
 
-        // Send 206 Partial Content response
+    // The receiver already has this version of the file
+    if (isNotModified(request, etag, lastModified)) {
         QString response = QString(
-            "HTTP/1.1 206 Partial Content\r\n"
-            "Content-Type: %1\r\n"
-            "Content-Length: %2\r\n"
-            "Content-Range: bytes %3-%4/%5\r\n"
+            "HTTP/1.1 304 Not Modified\r\n"
+            "%1"
             "Accept-Ranges: bytes\r\n"
             "Access-Control-Allow-Origin: *\r\n"
-            "Connection: close\r\n"
+            "%2"
             "\r\n"
-        ).arg(mimeType).arg(contentLength).arg(start).arg(end).arg(fileSize);
-
-        socket->write(response.toUtf8());
+        ).arg(validators, connectionHeader);
+        connection->sendResponse(response.toUtf8());
+        return;
+    }
 
-        // Seek to start position and send data
-        file.seek(start);
-        qint64 bytesToSend = contentLength;
-        const qint64 chunkSize = 64 * 1024; // 64KB chunks
+    // A Range is only honoured if If-Range (when present) still matches
+    std::vector<ByteRange> ranges;
+    RangeResult rangeResult = RangeResult::None;
+    if (request.hasHeader("range") && ifRangeMatches(request, etag, lastModified)) {
+        rangeResult = parseRanges(request.header("range"), fileSize, ranges);
+    }
 
-        while (bytesToSend > 0 && socket->isOpen()) {
-            qint64 toRead = qMin(chunkSize, bytesToSend);
-            QByteArray data = file.read(toRead);
-            if (data.isEmpty()) {
+    QString response;
+    std::vector<HttpConnection::FileRange> parts;
+    QByteArray trailer;
+
+    switch (rangeResult) {
+        case RangeResult::Unsatisfiable: {
+            response = QString(
+                "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                "Content-Range: bytes */%1\r\n"
+                "Content-Length: 0\r\n"
+                "%2"
+                "Access-Control-Allow-Origin: *\r\n"
+                "%3"
+                "\r\n"
+            ).arg(fileSize).arg(validators, connectionHeader);
+            connection->sendResponse(response.toUtf8());
+            return;
+        }
+        case RangeResult::Satisfiable: {
+            if (ranges.size() == 1) {
+                const ByteRange& range = ranges.front();
+                const qint64 contentLength = range.end - range.start + 1;
+
+                // Send 206 Partial Content response
+                response = QString(
+                    "HTTP/1.1 206 Partial Content\r\n"
+                    "Content-Type: %1\r\n"
+                    "Content-Length: %2\r\n"
+                    "Content-Range: bytes %3-%4/%5\r\n"
+                    "Accept-Ranges: bytes\r\n"
+                    "%6"
+                    "Access-Control-Allow-Origin: *\r\n"
+                    "%7"
+                    "\r\n"
+                ).arg(mimeType).arg(contentLength).arg(range.start).arg(range.end).arg(fileSize)
+                 .arg(validators, connectionHeader);
+
+                parts.push_back({{}, range.start, contentLength});
                 break;
             }
-            socket->write(data);
-            bytesToSend -= data.size();
+
+            // Several ranges: multipart/byteranges (RFC 7233 4.1)
+            const QByteArray boundary = QByteArray::number(QRandomGenerator::global()->generate64(), 16);
+            qint64 contentLength = 0;
+            for (const ByteRange& range : ranges) {
+                HttpConnection::FileRange part;
+                part.prefix = "\r\n--" + boundary + "\r\nContent-Type: " + mimeType.toUtf8()
+                            + "\r\nContent-Range: bytes " + QByteArray::number(range.start) + "-"
+                            + QByteArray::number(range.end) + "/" + QByteArray::number(fileSize) + "\r\n\r\n";
+                part.offset = range.start;
+                part.length = range.end - range.start + 1;
+                contentLength += part.prefix.size() + part.length;
+                parts.push_back(std::move(part));
+            }
+            trailer = "\r\n--" + boundary + "--\r\n";
+            contentLength += trailer.size();
+
+            response = QString(
+                "HTTP/1.1 206 Partial Content\r\n"
+                "Content-Type: multipart/byteranges; boundary=%1\r\n"
+                "Content-Length: %2\r\n"
+                "Accept-Ranges: bytes\r\n"
+                "%3"
+                "Access-Control-Allow-Origin: *\r\n"
+                "%4"
+                "\r\n"
+            ).arg(QString::fromLatin1(boundary)).arg(contentLength).arg(validators, connectionHeader);
+            break;
         }
-    } else {
-        // Send full file with 200 OK
-        QString response = QString(
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Type: %1\r\n"
-            "Content-Length: %2\r\n"
-            "Accept-Ranges: bytes\r\n"
-            "Access-Control-Allow-Origin: *\r\n"
-            "Connection: close\r\n"
-            "\r\n"
-        ).arg(mimeType).arg(fileSize);
+        case RangeResult::None: {
+            // Send full file with 200 OK
+            response = QString(
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: %1\r\n"
+                "Content-Length: %2\r\n"
+                "Accept-Ranges: bytes\r\n"
+                "%3"
+                "Access-Control-Allow-Origin: *\r\n"
+                "%4"
+                "\r\n"
+            ).arg(mimeType).arg(fileSize).arg(validators, connectionHeader);
+
+            parts.push_back({{}, 0, fileSize});
+            break;
+        }
+    }
 
-        socket->write(response.toUtf8());
+    // The body is streamed by the connection as the socket drains, so this
+    // returns immediately instead of blocking the event loop
+    if (!connection->sendFile(response.toUtf8(), filePath, std::move(parts), trailer)) {
+        send404(connection);
+    }
+}
 
-        // Send file data in chunks
-        const qint64 chunkSize = 64 * 1024; // 64KB chunks
-        while (!file.atEnd() && socket->isOpen()) {
-            QByteArray data = file.read(chunkSize);
-            socket->write(data);
-        }
+void HttpServer::serveGrowingFile(HttpConnection* connection, const QString& filePath,
+                                  std::shared_ptr<const GrowingFile> file)
+{
+    // Range and conditional headers are ignored (RFC 7233 3.1 allows this):
+    // there is no length to satisfy them against yet
+    const QString response = QString(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %1\r\n"
+        "Accept-Ranges: none\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+    ).arg(getMimeType(filePath));
+
+    // The writer may have moved the complete file into place since the lookup
+    const QString readPath = QFile::exists(file->writePath) ? file->writePath : filePath;
+
+    qInfo() << "Streaming growing file:" << readPath;
+
+    const bool started = connection->sendGrowingFile(response.toUtf8(), readPath, [file = std::move(file)]() {
+        return file->growing.load();
+    });
+    if (!started) {
+        send404(connection);
     }
+}
+
+void HttpServer::serveLiveStream(HttpConnection* connection, const QString& path, std::shared_ptr<LiveStream> stream)
+{
+    const QString response = QString(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %1\r\n"
+        "Accept-Ranges: none\r\n"
+        "Cache-Control: no-cache, no-store\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+    ).arg(getMimeType(path));
+
+    qInfo() << "Streaming live audio:" << path;
 
-    socket->flush();
-    socket->waitForBytesWritten();
-    socket->disconnectFromHost();
+    // Each response keeps its own position in the stream
+    auto reader = std::make_shared<LiveStream::Reader>();
+    connection->sendStream(
+        response.toUtf8(),
+        [stream, reader](char* data, qint64 maxSize) { return stream->read(*reader, data, maxSize); },
+        [stream]() { return !stream->isFinished(); });
 }
 
-void HttpServer::serveCover(QTcpSocket* socket, const QString& mediaPath)
+QByteArray HttpServer::entityTag(qint64 size, const QDateTime& lastModified)
 {
-    if (!m_audioLoader) {
-        qWarning() << "AudioLoader not available for cover extraction";
-        send404(socket);
-        return;
+    // Strong validator: changes whenever the file is rewritten or resized
+    return '"' + QByteArray::number(size, 16) + "-" + QByteArray::number(lastModified.toMSecsSinceEpoch(), 16) + '"';
+}
+
+QByteArray HttpServer::coverEntityTag(qint64 mediaSize, const QDateTime& mediaModified, int maxDimension)
+{
+    // Distinct from the media file's own tag and from other scaled variants
+    QByteArray etag = entityTag(mediaSize, mediaModified);
+    etag.insert(1, "cover" + QByteArray::number(maxDimension) + "-");
+    return etag;
+}
+
+QByteArray HttpServer::httpDate(const QDateTime& dateTime)
+{
+    return QLocale::c().toString(dateTime.toUTC(), QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'")).toLatin1();
+}
+
+bool HttpServer::isNotModified(const HttpRequest& request, const QByteArray& etag, const QByteArray& lastModified)
+{
+    // If-None-Match takes precedence over If-Modified-Since (RFC 7232 6)
+    if (request.hasHeader("if-none-match")) {
+        return etagListMatches(request.header("if-none-match"), etag, true);
     }
 
-    // Create a Track object for the media file
-    Fooyin::Track track(mediaPath);
+    // Receivers echo back the Last-Modified value we sent, so an exact
+    // match is enough and avoids parsing HTTP dates
+    if (request.hasHeader("if-modified-since")) {
+        return equals(request.header("if-modified-since"), lastModified);
+    }
 
-    // Extract cover art using AudioLoader
-    QByteArray coverData = m_audioLoader->readTrackCover(track, Fooyin::Track::Cover::Front);
+    return false;
+}
 
-    if (coverData.isEmpty()) {
-        qInfo() << "No cover art found for:" << mediaPath;
-        send404(socket);
+bool HttpServer::ifRangeMatches(const HttpRequest& request, const QByteArray& etag, const QByteArray& lastModified)
+{
+    if (!request.hasHeader("if-range")) {
+        return true;
+    }
+
+    // If-Range requires a strong match (RFC 7233 3.2)
+    const QByteArrayView value = request.header("if-range");
+    if (value.startsWith("\"") || value.startsWith("W/")) {
+        return etagListMatches(value, etag, false);
+    }
+    return equals(value, lastModified);
+}
+
+HttpServer::RangeResult HttpServer::parseRanges(QByteArrayView header, qint64 fileSize, std::vector<ByteRange>& ranges)
+{
+    // Range: bytes=0-499, 1000-, -500
+    if (!header.startsWith("bytes=")) {
+        return RangeResult::None;
+    }
+
+    const QList<QByteArray> specs = header.sliced(6).toByteArray().split(',');
+    if (specs.size() > MaxRanges) {
+        return RangeResult::None;
+    }
+
+    for (const QByteArray& rawSpec : specs) {
+        const QByteArray spec = rawSpec.trimmed();
+        const qsizetype dash = spec.indexOf('-');
+        if (dash < 0) {
+            // Syntactically invalid - ignore the whole header
+            return RangeResult::None;
+        }
+
+        const QByteArray first = spec.left(dash).trimmed();
+        const QByteArray last = spec.mid(dash + 1).trimmed();
+        ByteRange range;
+
+        if (first.isEmpty()) {
+            // Suffix range: the final N bytes
+            qint64 suffixLength{0};
+            if (!parseByteOffset(last, suffixLength)) {
+                return RangeResult::None;
+            }
+            if (suffixLength == 0 || fileSize == 0) {
+                continue;
+            }
+            range.start = std::max<qint64>(0, fileSize - suffixLength);
+            range.end = fileSize - 1;
+        } else {
+            if (!parseByteOffset(first, range.start)) {
+                return RangeResult::None;
+            }
+            range.end = fileSize - 1;
+            if (!last.isEmpty()) {
+                if (!parseByteOffset(last, range.end) || range.end < range.start) {
+                    return RangeResult::None;
+                }
+                range.end = std::min(range.end, fileSize - 1);
+            }
+            if (range.start >= fileSize) {
+                continue;
+            }
+        }
+
+        ranges.push_back(range);
+    }
+
+    if (ranges.empty()) {
+        return RangeResult::Unsatisfiable;
+    }
+
+    // Coalesce overlapping or adjacent ranges so no byte is sent twice
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) { return a.start < b.start; });
+    std::vector<ByteRange> merged;
+    for (const ByteRange& range : ranges) {
+        if (!merged.empty() && range.start <= merged.back().end + 1) {
+            merged.back().end = std::max(merged.back().end, range.end);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    ranges = std::move(merged);
+
+    return RangeResult::Satisfiable;
+}
+
+void HttpServer::onFileSent(Chromecast::HttpConnection::TransferMode mode, qint64 bytes)
+{
+    if (mode == HttpConnection::TransferMode::SendFile) {
+        m_sendFileResponses.fetch_add(1, std::memory_order_relaxed);
+        m_sendFileBytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    } else {
+        m_copyResponses.fetch_add(1, std::memory_order_relaxed);
+        m_copyBytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    }
+}
+
+void HttpServer::serveCover(HttpConnection* connection, const HttpRequest& request, const QString& mediaPath)
+{
+    const QFileInfo fileInfo(mediaPath);
+    if (!fileInfo.isFile()) {
+        qWarning() << "Media file for cover not found:" << mediaPath;
+        send404(connection);
         return;
     }
 
-    qInfo() << "Serving cover art for:" << mediaPath << "Size:" << coverData.size() << "bytes";
+    // The cover can only change when the media file does, so its validators
+    // are derived from the media file and checked before any tag parsing
+    const int maxDimension = m_coverMaxDimension.load();
+    const QDateTime modified = fileInfo.lastModified();
+    const QByteArray etag = coverEntityTag(fileInfo.size(), modified, maxDimension);
+    const QByteArray lastModified = httpDate(modified);
+    const QString validators = QString("ETag: %1\r\nLast-Modified: %2\r\n")
+                                   .arg(QString::fromLatin1(etag), QString::fromLatin1(lastModified));
+    const QString connectionHeader = QString::fromLatin1(connection->connectionHeader());
+
+    if (isNotModified(request, etag, lastModified)) {
+        QString response = QString(
+            "HTTP/1.1 304 Not Modified\r\n"
+            "%1"
+            "Access-Control-Allow-Origin: *\r\n"
+            "Cache-Control: max-age=3600\r\n"
+            "%2"
+            "\r\n"
+        ).arg(validators, connectionHeader);
+        connection->sendResponse(response.toUtf8());
+        return;
+    }
 
-    // Determine MIME type from image data
-    QString mimeType = "image/jpeg";  // Default
-    if (coverData.startsWith("\x89PNG")) {
-        mimeType = "image/png";
-    } else if (coverData.startsWith("GIF")) {
-        mimeType = "image/gif";
-    } else if (coverData.startsWith("\xFF\xD8\xFF")) {
-        mimeType = "image/jpeg";
+    // Scaling runs here on the HTTP worker thread, once per cover and size
+    const CoverCache::Key key{mediaPath, fileInfo.size(), modified.toMSecsSinceEpoch(), maxDimension};
+    CoverCache::Entry cover;
+    if (!m_coverCache.find(key, cover)) {
+        cover = loadCover(mediaPath, maxDimension);
+        m_coverCache.insert(key, cover);
     }
 
+    if (cover.data.isEmpty()) {
+        qDebug() << "No cover art found for:" << mediaPath;
+        send404(connection);
+        return;
+    }
+
+    qDebug() << "Serving cover art for:" << mediaPath << "Size:" << cover.data.size() << "bytes";
+
     // Send HTTP response with cover image
     QString response = QString(
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: %1\r\n"
         "Content-Length: %2\r\n"
+        "%3"
         "Access-Control-Allow-Origin: *\r\n"
         "Cache-Control: max-age=3600\r\n"
-        "Connection: close\r\n"
+        "%4"
         "\r\n"
-    ).arg(mimeType).arg(coverData.size());
+    ).arg(cover.mimeType).arg(cover.data.size()).arg(validators, connectionHeader);
 
-    socket->write(response.toUtf8());
-    socket->write(coverData);
-    socket->flush();
-    socket->waitForBytesWritten();
-    socket->disconnectFromHost();
+    connection->sendResponse(response.toUtf8(), cover.data);
 }
 
-void HttpServer::send404(QTcpSocket* socket)
+CoverCache::Entry HttpServer::loadCover(const QString& mediaPath, int maxDimension) const
 {
-    QString response =
+    CoverCache::Entry cover;
+
+    if (!m_audioLoader) {
+        qWarning() << "AudioLoader not available for cover extraction";
+        return cover;
+    }
+
+    // Create a Track object for the media file
+    Fooyin::Track track(mediaPath);
+
+    // Extract cover art using AudioLoader, which isn't documented as
+    // re-entrant; only the scaling below runs on several workers at once
+    {
+        const QMutexLocker locker(&m_audioLoaderLock);
+        cover.data = m_audioLoader->readTrackCover(track, Fooyin::Track::Cover::Front);
+    }
+    if (cover.data.isEmpty()) {
+        qInfo() << "No cover art found for:" << mediaPath;
+        return cover;
+    }
+
+    // Determine MIME type from image data
+    cover.mimeType = "image/jpeg";  // Default
+    if (cover.data.startsWith("\x89PNG")) {
+        cover.mimeType = "image/png";
+    } else if (cover.data.startsWith("GIF")) {
+        cover.mimeType = "image/gif";
+    } else if (cover.data.startsWith("\xFF\xD8\xFF")) {
+        cover.mimeType = "image/jpeg";
+    }
+
+    if (maxDimension > 0) {
+        return scaleCover(cover, maxDimension);
+    }
+
+    return cover;
+}
+
+CoverCache::Entry HttpServer::scaleCover(const CoverCache::Entry& cover, int maxDimension)
+{
+    QImage image;
+    if (!image.loadFromData(cover.data)) {
+        qWarning() << "Failed to decode cover art, serving original";
+        return cover;
+    }
+
+    // Small enough already - re-encoding would only lose quality
+    if (image.width() <= maxDimension && image.height() <= maxDimension) {
+        return cover;
+    }
+
+    const QSize originalSize = image.size();
+    image = image.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (image.hasAlphaChannel()) {
+        // JPEG has no alpha channel
+        image = image.convertToFormat(QImage::Format_RGB32);
+    }
+
+    CoverCache::Entry scaled;
+    QBuffer buffer(&scaled.data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", CoverJpegQuality)) {
+        qWarning() << "Failed to encode scaled cover art, serving original";
+        return cover;
+    }
+    scaled.mimeType = "image/jpeg";
+
+    qDebug() << "Scaled cover art from" << originalSize << "(" << cover.data.size() << "bytes ) to" << image.size()
+             << "(" << scaled.data.size() << "bytes )";
+
+    return scaled;
+}
+
+void HttpServer::send404(HttpConnection* connection)
+{
+    const QByteArray body = "404 Not Found";
+    const QByteArray response =
         "HTTP/1.1 404 Not Found\r\n"
         "Content-Type: text/plain\r\n"
-        "Content-Length: 13\r\n"
-        "Connection: close\r\n"
-        "\r\n"
-        "404 Not Found";
+        "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+        + connection->connectionHeader()
+        + "\r\n";
 
-    socket->write(response.toUtf8());
-    socket->flush();
-    socket->disconnectFromHost();
+    connection->sendResponse(response, body);
 }
 
 QString HttpServer::getMimeType(const QString& filePath) const
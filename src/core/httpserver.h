@@ -19,13 +19,27 @@
 
 #pragma once
 
+#include "covercache.h"
+#include "httpconnection.h"
+#include "linkmonitor.h"
+#include "livestream.h"
+#include "mediaregistry.h"
+
 #include <QObject>
+#include <QDateTime>
 #include <QHostAddress>
+#include <QNetworkAddressEntry>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QHash>
 #include <QMap>
+#include <QMutex>
 
+#include <atomic>
 #include <memory>
+#include <vector>
+
+class QThread;
 
 namespace Fooyin {
 class AudioLoader;
@@ -33,44 +47,171 @@ class AudioLoader;
 
 namespace Chromecast {
 
+/*!
+ * Embedded HTTP server that serves media files and cover art to receivers.
+ *
+ * Connections are accepted on the thread that owns the server and handed
+ * to a small pool of worker threads, so disk reads and cover extraction
+ * never delay the Cast heartbeat or the UI. Request handling runs on the
+ * worker threads and only touches the thread-safe MediaRegistry.
+ *
+ * Every connection reports how fast its responses drain into a LinkMonitor,
+ * giving a throughput estimate per receiver.
+ */
 class HttpServer : public QObject
 {
     Q_OBJECT
 
 public:
+    // How file bodies were delivered since the server started
+    struct TransferStats
+    {
+        quint64 sendFileResponses{0};
+        quint64 sendFileBytes{0};
+        quint64 copyResponses{0};
+        quint64 copyBytes{0};
+    };
+
     explicit HttpServer(std::shared_ptr<Fooyin::AudioLoader> audioLoader, QObject* parent = nullptr);
     ~HttpServer() override;
 
+    // Number of connection worker threads, applied on the next start()
+    void setWorkerThreadCount(int count);
+    int workerThreadCount() const;
+    static int defaultWorkerThreadCount();
+
     bool start(quint16 port = 8010);
     void stop();
     bool isRunning() const;
     QHostAddress serverAddress() const;
     quint16 serverPort() const;
+    // Base URL for media and cover links, using the cached local address
     QString serverUrl() const;
+    // Prefer the local address the receiver can reach. routeAddress is the
+    // local end of an existing connection to it, if any.
+    void setReceiverAddress(const QHostAddress& receiver, const QHostAddress& routeAddress = {});
 
     QString createMediaUrl(const QString& mediaPath);
     QString createCoverUrl(const QString& mediaPath);
 
+    // A file still being written (e.g. by the transcoder) is served from the
+    // start with chunked encoding, following it as it grows until finished
+    // writePath is where the data is until it is complete, if not filePath.
+    void beginGrowingFile(const QString& filePath, const QString& writePath = {});
+    void finishGrowingFile(const QString& filePath);
+
+    // Publish audio encoded while it plays under a new URL ending in
+    // ".suffix". Receivers can connect until the stream is removed.
+    QString addLiveStream(std::shared_ptr<LiveStream> stream, const QString& suffix);
+    void removeLiveStream(const std::shared_ptr<LiveStream>& stream);
+
+    // Keep the URLs of these files (current and queued tracks) from expiring
+    void retainMedia(MediaRegistry::Holder holder, const QStringList& mediaPaths);
+    MediaRegistry::Stats registryStats() const;
+
+    TransferStats transferStats() const;
+
+    // Measured link to a receiver and the bitrate it sustains (kbit/s, 0 if unknown)
+    LinkMonitor::Link linkStats(const QHostAddress& peer) const;
+    int sustainableBitrate(const QHostAddress& peer) const;
+
+    void setCoverCacheSize(qint64 bytes);
+    // Covers larger than this are downscaled and re-encoded as JPEG, 0 serves them untouched
+    void setCoverMaxDimension(int pixels);
+    CoverCache::Stats coverCacheStats() const;
+
 signals:
     void requestReceived(const QString& path);
     void error(const QString& message);
+    // A new throughput sample or stall was recorded for peer. Emitted on
+    // a worker thread.
+    void linkMeasured(const QHostAddress& peer);
 
 private slots:
-    void onNewConnection();
-    void onReadyRead();
-    void onDisconnected();
+    // Called on worker threads
+    void handleRequest(Chromecast::HttpConnection* connection, const Chromecast::HttpRequest& request);
+    void onFileSent(Chromecast::HttpConnection::TransferMode mode, qint64 bytes);
+    void refreshAddresses();
 
 private:
-    void handleRequest(QTcpSocket* socket, const QString& request);
-    void serveFile(QTcpSocket* socket, const QString& filePath, qint64 start = -1, qint64 end = -1);
-    void serveCover(QTcpSocket* socket, const QString& mediaPath);
-    void send404(QTcpSocket* socket);
+    struct Worker
+    {
+        QThread* thread{nullptr};
+        QObject* context{nullptr}; // Lives on thread, parents its connections
+        std::atomic<int> connections{0};
+    };
+
+    void startWorkers();
+    void stopWorkers();
+    void dispatchConnection(qintptr socketDescriptor);
+    void logDiagnostics() const;
+    void selectAddress();
+
+    struct ByteRange
+    {
+        qint64 start{0};
+        qint64 end{0}; // Inclusive
+    };
+
+    enum class RangeResult
+    {
+        None,         // No (usable) Range header - send the whole file
+        Satisfiable,
+        Unsatisfiable // 416
+    };
+
+    static QByteArray entityTag(qint64 size, const QDateTime& lastModified);
+    static QByteArray coverEntityTag(qint64 mediaSize, const QDateTime& mediaModified, int maxDimension);
+    static QByteArray httpDate(const QDateTime& dateTime);
+    static bool isNotModified(const HttpRequest& request, const QByteArray& etag, const QByteArray& lastModified);
+    static bool ifRangeMatches(const HttpRequest& request, const QByteArray& etag, const QByteArray& lastModified);
+    static RangeResult parseRanges(QByteArrayView header, qint64 fileSize, std::vector<ByteRange>& ranges);
+
+    void serveFile(HttpConnection* connection, const HttpRequest& request, const QString& filePath);
+    struct GrowingFile
+    {
+        std::atomic<bool> growing{true};
+        QString writePath;
+    };
+
+    void serveGrowingFile(HttpConnection* connection, const QString& filePath,
+                          std::shared_ptr<const GrowingFile> file);
+    std::shared_ptr<const GrowingFile> growingFile(const QString& filePath) const;
+    void serveLiveStream(HttpConnection* connection, const QString& path, std::shared_ptr<LiveStream> stream);
+    void serveCover(HttpConnection* connection, const HttpRequest& request, const QString& mediaPath);
+    CoverCache::Entry loadCover(const QString& mediaPath, int maxDimension) const;
+    static CoverCache::Entry scaleCover(const CoverCache::Entry& cover, int maxDimension);
+    void send404(HttpConnection* connection);
     QString getMimeType(const QString& filePath) const;
 
     std::shared_ptr<Fooyin::AudioLoader> m_audioLoader;
+    mutable QMutex m_audioLoaderLock; // Serializes cover reads from the workers
     QTcpServer* m_server{nullptr};
-    QMap<QString, QString> m_mediaFiles; // URL path -> file path mapping
-    QMap<QString, QString> m_coverFiles; // URL path -> media file path (for cover extraction)
+    MediaRegistry m_registry;
+    LinkMonitor m_links;
+    CoverCache m_coverCache;
+    std::atomic<int> m_coverMaxDimension{0};
+
+    // Shared with in-flight responses, which outlive the entry
+    mutable QMutex m_growingLock;
+    QHash<QString, std::shared_ptr<GrowingFile>> m_growingFiles;
+    // URL path -> stream
+    QHash<QString, std::shared_ptr<LiveStream>> m_liveStreams;
+    quint64 m_nextLiveStream{1};
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    int m_workerThreadCount;
+
+    std::atomic<quint64> m_sendFileResponses{0};
+    std::atomic<quint64> m_sendFileBytes{0};
+    std::atomic<quint64> m_copyResponses{0};
+    std::atomic<quint64> m_copyBytes{0};
+
+    // Local IPv4 addresses, refreshed on network changes
+    QList<QNetworkAddressEntry> m_localAddresses;
+    QHostAddress m_receiverAddress;
+    QHostAddress m_routeAddress;
+    QString m_baseUrl;
+
     bool m_isRunning{false};
     quint16 m_port{8010};
 };
@@ -0,0 +1,241 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+// Shared by the libav based transcoders; only built with CHROMECAST_HAVE_LIBAV
+
+#include <QString>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/avutil.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <algorithm>
+#include <memory>
+
+namespace Chromecast::Libav {
+
+// Frame size for encoders that accept any number of samples (PCM, FLAC)
+constexpr int VariableFrameSize = 4096;
+// Receivers only need stereo; matches what they decode everywhere
+constexpr int MaxChannels = 2;
+
+struct InputDeleter
+{
+    void operator()(AVFormatContext* context) const
+    {
+        avformat_close_input(&context);
+    }
+};
+
+struct OutputDeleter
+{
+    void operator()(AVFormatContext* context) const
+    {
+        // Custom IO contexts are freed by their owner
+        if (context->pb && !(context->flags & AVFMT_FLAG_CUSTOM_IO)) {
+            avio_closep(&context->pb);
+        }
+        avformat_free_context(context);
+    }
+};
+
+struct CodecDeleter
+{
+    void operator()(AVCodecContext* context) const
+    {
+        avcodec_free_context(&context);
+    }
+};
+
+struct ResamplerDeleter
+{
+    void operator()(SwrContext* context) const
+    {
+        swr_free(&context);
+    }
+};
+
+struct FifoDeleter
+{
+    void operator()(AVAudioFifo* fifo) const
+    {
+        av_audio_fifo_free(fifo);
+    }
+};
+
+struct FrameDeleter
+{
+    void operator()(AVFrame* frame) const
+    {
+        av_frame_free(&frame);
+    }
+};
+
+struct PacketDeleter
+{
+    void operator()(AVPacket* packet) const
+    {
+        av_packet_free(&packet);
+    }
+};
+
+// Buffer argument of AVIOContext write callbacks
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+using IoBuffer = const uint8_t*;
+#else
+using IoBuffer = uint8_t*;
+#endif
+
+using InputPtr     = std::unique_ptr<AVFormatContext, InputDeleter>;
+using OutputPtr    = std::unique_ptr<AVFormatContext, OutputDeleter>;
+using CodecPtr     = std::unique_ptr<AVCodecContext, CodecDeleter>;
+using ResamplerPtr = std::unique_ptr<SwrContext, ResamplerDeleter>;
+using FifoPtr      = std::unique_ptr<AVAudioFifo, FifoDeleter>;
+using FramePtr     = std::unique_ptr<AVFrame, FrameDeleter>;
+using PacketPtr    = std::unique_ptr<AVPacket, PacketDeleter>;
+
+// Growable planar or packed sample buffer for resampler output
+class SampleBuffer
+{
+public:
+    SampleBuffer(int channels, AVSampleFormat format)
+        : m_channels{channels}
+        , m_format{format}
+    { }
+
+    ~SampleBuffer()
+    {
+        release();
+    }
+
+    SampleBuffer(const SampleBuffer&)            = delete;
+    SampleBuffer& operator=(const SampleBuffer&) = delete;
+
+    uint8_t** reserve(int samples)
+    {
+        if (samples > m_capacity) {
+            release();
+            if (av_samples_alloc_array_and_samples(&m_data, nullptr, m_channels, samples, m_format, 0) < 0) {
+                return nullptr;
+            }
+            m_capacity = samples;
+        }
+        return m_data;
+    }
+
+private:
+    void release()
+    {
+        if (m_data) {
+            av_freep(&m_data[0]);
+            av_freep(&m_data);
+        }
+        m_capacity = 0;
+    }
+
+    int m_channels;
+    AVSampleFormat m_format;
+    uint8_t** m_data{nullptr};
+    int m_capacity{0};
+};
+
+inline QString avError(int error)
+{
+    char buffer[AV_ERROR_MAX_STRING_SIZE]{};
+    av_strerror(error, buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+inline const int* supportedSampleRates(const AVCodec* codec)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* rates{nullptr};
+    if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_RATE, 0, &rates, nullptr) < 0) {
+        return nullptr;
+    }
+    return static_cast<const int*>(rates);
+#else
+    return codec->supported_samplerates;
+#endif
+}
+
+inline const AVSampleFormat* supportedSampleFormats(const AVCodec* codec)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* formats{nullptr};
+    if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, &formats, nullptr) < 0) {
+        return nullptr;
+    }
+    return static_cast<const AVSampleFormat*>(formats);
+#else
+    return codec->sample_fmts;
+#endif
+}
+
+// The input rate if the encoder takes it, else the closest rate above it,
+// else the highest it has
+inline int chooseSampleRate(const AVCodec* codec, int inputRate)
+{
+    const int* rates = supportedSampleRates(codec);
+    if (!rates) {
+        return inputRate;
+    }
+
+    int above{0};
+    int highest{0};
+    for (; *rates != 0; ++rates) {
+        if (*rates == inputRate) {
+            return inputRate;
+        }
+        if (*rates > inputRate && (above == 0 || *rates < above)) {
+            above = *rates;
+        }
+        highest = std::max(highest, *rates);
+    }
+    return above != 0 ? above : highest;
+}
+
+// The input format (or its packed/planar twin) if the encoder takes it, so
+// e.g. 24-bit FLAC stays 24-bit; else the encoder's preferred format
+inline AVSampleFormat chooseSampleFormat(const AVCodec* codec, AVSampleFormat inputFormat)
+{
+    const AVSampleFormat* formats = supportedSampleFormats(codec);
+    if (!formats) {
+        return inputFormat;
+    }
+
+    const AVSampleFormat packed = av_get_packed_sample_fmt(inputFormat);
+    const AVSampleFormat planar = av_get_planar_sample_fmt(inputFormat);
+    for (const AVSampleFormat* format = formats; *format != AV_SAMPLE_FMT_NONE; ++format) {
+        if (*format == inputFormat || *format == packed || *format == planar) {
+            return *format;
+        }
+    }
+    return formats[0];
+}
+
+} // namespace Chromecast::Libav
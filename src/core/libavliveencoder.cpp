@@ -0,0 +1,342 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "libavliveencoder.h"
+
+#include "livestream.h"
+#include "transcodingmanager.h"
+
+#include <core/engine/audioformat.h>
+
+#include <QDebug>
+
+using namespace Chromecast::Libav;
+
+namespace {
+
+// Large enough for any single packet, so each flush is one whole packet
+constexpr int IoBufferSize = 64 * 1024;
+
+// Whether a reader can start decoding at data, one write of the muxer:
+// an Ogg page (Opus) or a FLAC frame, the live formats there are
+bool isSyncPoint(const QByteArray& data)
+{
+    if (data.startsWith("OggS")) {
+        return true;
+    }
+    // 14-bit frame sync code
+    return data.size() >= 2 && static_cast<uchar>(data.at(0)) == 0xFF
+        && (static_cast<uchar>(data.at(1)) & 0xFE) == 0xF8;
+}
+
+AVSampleFormat inputSampleFormat(Fooyin::SampleFormat format)
+{
+    switch (format) {
+        case Fooyin::SampleFormat::U8:
+            return AV_SAMPLE_FMT_U8;
+        case Fooyin::SampleFormat::S16:
+            return AV_SAMPLE_FMT_S16;
+        case Fooyin::SampleFormat::S24In32:
+        case Fooyin::SampleFormat::S32:
+            return AV_SAMPLE_FMT_S32;
+        case Fooyin::SampleFormat::F32:
+            return AV_SAMPLE_FMT_FLT;
+        case Fooyin::SampleFormat::F64:
+            return AV_SAMPLE_FMT_DBL;
+        default:
+            return AV_SAMPLE_FMT_NONE;
+    }
+}
+
+} // namespace
+
+namespace Chromecast {
+
+LibavLiveEncoder::LibavLiveEncoder(std::shared_ptr<LiveStream> stream)
+    : m_stream(std::move(stream))
+{ }
+
+LibavLiveEncoder::~LibavLiveEncoder()
+{
+    finish();
+
+    m_output.reset();
+    if (m_io) {
+        av_freep(&m_io->buffer);
+        avio_context_free(&m_io);
+    }
+}
+
+bool LibavLiveEncoder::isFormatSupported(TranscodingFormat format)
+{
+    switch (format) {
+        case TranscodingFormat::FLAC:
+        case TranscodingFormat::Opus:
+            return avcodec_find_encoder_by_name(TranscodingManager::encoderName(format).toUtf8().constData())
+                != nullptr;
+        default:
+            return false;
+    }
+}
+
+bool LibavLiveEncoder::open(TranscodingFormat format, TranscodingQuality quality, const Fooyin::AudioFormat& input,
+                            QString& error)
+{
+    const AVSampleFormat inputFormat = inputSampleFormat(input.sampleFormat());
+    if (inputFormat == AV_SAMPLE_FMT_NONE || input.sampleRate() <= 0 || input.channelCount() <= 0) {
+        error = "Unsupported input audio format";
+        return false;
+    }
+    m_inputChannels = input.channelCount();
+    m_expand24      = input.sampleFormat() == Fooyin::SampleFormat::S24In32;
+
+    const QString encoderName = TranscodingManager::encoderName(format);
+    const AVCodec* encoder = avcodec_find_encoder_by_name(encoderName.toUtf8().constData());
+    if (!encoder) {
+        error = QString("Encoder %1 is not available").arg(encoderName);
+        return false;
+    }
+
+    // Output through our own IO context into the stream
+    AVFormatContext* rawOutput{nullptr};
+    int ret = avformat_alloc_output_context2(&rawOutput, nullptr,
+                                             TranscodingManager::muxerName(format).toUtf8().constData(), nullptr);
+    if (ret < 0 || !rawOutput) {
+        error = QString("Cannot create output: %1").arg(avError(ret));
+        return false;
+    }
+    m_output.reset(rawOutput);
+
+    auto* ioBuffer = static_cast<uint8_t*>(av_malloc(IoBufferSize));
+    m_io = ioBuffer ? avio_alloc_context(ioBuffer, IoBufferSize, 1, this, nullptr, &writeOutput, nullptr) : nullptr;
+    if (!m_io) {
+        av_free(ioBuffer);
+        error = "Out of memory";
+        return false;
+    }
+    m_output->pb = m_io;
+    m_output->flags |= AVFMT_FLAG_CUSTOM_IO | AVFMT_FLAG_FLUSH_PACKETS;
+
+    m_encoder.reset(avcodec_alloc_context3(encoder));
+    if (!m_encoder) {
+        error = "Out of memory";
+        return false;
+    }
+    const int sampleRate = chooseSampleRate(encoder, input.sampleRate());
+    m_encoder->sample_rate = sampleRate;
+    m_encoder->sample_fmt  = chooseSampleFormat(encoder, inputFormat);
+    m_encoder->time_base   = {1, sampleRate};
+    av_channel_layout_default(&m_encoder->ch_layout, std::min(m_inputChannels, MaxChannels));
+    if (const int kbps = TranscodingManager::bitrate(format, quality); kbps > 0) {
+        m_encoder->bit_rate = kbps * 1000;
+    }
+    if (m_output->oformat->flags & AVFMT_GLOBALHEADER) {
+        m_encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if ((ret = avcodec_open2(m_encoder.get(), encoder, nullptr)) < 0) {
+        error = QString("Cannot open encoder %1: %2").arg(encoderName, avError(ret));
+        return false;
+    }
+
+    m_outStream = avformat_new_stream(m_output.get(), nullptr);
+    if (!m_outStream) {
+        error = "Out of memory";
+        return false;
+    }
+    avcodec_parameters_from_context(m_outStream->codecpar, m_encoder.get());
+    m_outStream->time_base = m_encoder->time_base;
+
+    if ((ret = avformat_write_header(m_output.get(), nullptr)) < 0) {
+        error = QString("Cannot write stream header: %1").arg(avError(ret));
+        return false;
+    }
+    avio_flush(m_io);
+    m_stream->setHeader(m_header);
+    m_headerWritten = true;
+
+    AVChannelLayout inputLayout;
+    av_channel_layout_default(&inputLayout, m_inputChannels);
+    SwrContext* rawResampler{nullptr};
+    ret = swr_alloc_set_opts2(&rawResampler, &m_encoder->ch_layout, m_encoder->sample_fmt, m_encoder->sample_rate,
+                              &inputLayout, inputFormat, input.sampleRate(), 0, nullptr);
+    av_channel_layout_uninit(&inputLayout);
+    m_resampler.reset(rawResampler);
+    if (ret < 0 || (ret = swr_init(m_resampler.get())) < 0) {
+        error = QString("Cannot set up resampler: %1").arg(avError(ret));
+        return false;
+    }
+
+    const bool variableFrames = (encoder->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)
+                             || m_encoder->frame_size <= 0;
+    m_frameSize      = variableFrames ? VariableFrameSize : m_encoder->frame_size;
+    m_smallLastFrame = variableFrames || (encoder->capabilities & AV_CODEC_CAP_SMALL_LAST_FRAME);
+
+    m_fifo.reset(av_audio_fifo_alloc(m_encoder->sample_fmt, m_encoder->ch_layout.nb_channels, m_frameSize));
+    m_frame.reset(av_frame_alloc());
+    m_packet.reset(av_packet_alloc());
+    m_converted = std::make_unique<SampleBuffer>(m_encoder->ch_layout.nb_channels, m_encoder->sample_fmt);
+    if (!m_fifo || !m_frame || !m_packet) {
+        error = "Out of memory";
+        return false;
+    }
+
+    qInfo() << "Live encoding" << input.sampleRate() << "Hz," << m_inputChannels << "channels to" << encoderName
+            << "at" << sampleRate << "Hz";
+
+    m_open = true;
+    return true;
+}
+
+bool LibavLiveEncoder::write(const char* data, int frames)
+{
+    if (!m_open || m_finished || frames <= 0) {
+        return false;
+    }
+
+    const auto* input = reinterpret_cast<const uint8_t*>(data);
+
+    if (m_expand24) {
+        // 24 significant bits in the low end of each 32-bit sample
+        const auto* samples = reinterpret_cast<const int32_t*>(data);
+        const size_t count  = static_cast<size_t>(frames) * m_inputChannels;
+        m_expanded.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_expanded[i] = static_cast<int32_t>(static_cast<uint32_t>(samples[i]) << 8);
+        }
+        input = reinterpret_cast<const uint8_t*>(m_expanded.data());
+    }
+
+    const int maxSamples = swr_get_out_samples(m_resampler.get(), frames);
+    uint8_t** buffer     = m_converted->reserve(std::max(maxSamples, 1));
+    if (!buffer) {
+        return false;
+    }
+
+    const int samples = swr_convert(m_resampler.get(), buffer, maxSamples, &input, frames);
+    if (samples < 0) {
+        qWarning() << "Live encoder: Resampling failed:" << avError(samples);
+        return false;
+    }
+    if (samples > 0 && av_audio_fifo_write(m_fifo.get(), reinterpret_cast<void**>(buffer), samples) < samples) {
+        return false;
+    }
+
+    return encodeQueued(false);
+}
+
+void LibavLiveEncoder::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    if (m_open) {
+        // Drain the resampler, then the frame queue, then the encoder
+        const int maxSamples = swr_get_out_samples(m_resampler.get(), 0);
+        if (maxSamples > 0) {
+            if (uint8_t** buffer = m_converted->reserve(maxSamples)) {
+                const int samples = swr_convert(m_resampler.get(), buffer, maxSamples, nullptr, 0);
+                if (samples > 0) {
+                    av_audio_fifo_write(m_fifo.get(), reinterpret_cast<void**>(buffer), samples);
+                }
+            }
+        }
+        if (encodeQueued(true) && writePackets(nullptr)) {
+            av_write_trailer(m_output.get());
+            avio_flush(m_io);
+        }
+    }
+
+    m_stream->finish();
+}
+
+int LibavLiveEncoder::writeOutput(void* opaque, IoBuffer data, int size)
+{
+    auto* self = static_cast<LibavLiveEncoder*>(opaque);
+
+    const QByteArray bytes(reinterpret_cast<const char*>(data), size);
+    if (self->m_headerWritten) {
+        self->m_stream->append(bytes, isSyncPoint(bytes));
+    } else {
+        self->m_header.append(bytes);
+    }
+
+    return size;
+}
+
+bool LibavLiveEncoder::encodeQueued(bool flush)
+{
+    AVCodecContext* enc = m_encoder.get();
+
+    while (av_audio_fifo_size(m_fifo.get()) >= m_frameSize || (flush && av_audio_fifo_size(m_fifo.get()) > 0)) {
+        const int samples = std::min(av_audio_fifo_size(m_fifo.get()), m_frameSize);
+
+        av_frame_unref(m_frame.get());
+        m_frame->nb_samples  = m_smallLastFrame ? samples : m_frameSize;
+        m_frame->format      = enc->sample_fmt;
+        m_frame->sample_rate = enc->sample_rate;
+        av_channel_layout_copy(&m_frame->ch_layout, &enc->ch_layout);
+        if (av_frame_get_buffer(m_frame.get(), 0) < 0) {
+            return false;
+        }
+        if (m_frame->nb_samples > samples) {
+            av_samples_set_silence(m_frame->extended_data, samples, m_frame->nb_samples - samples,
+                                   enc->ch_layout.nb_channels, enc->sample_fmt);
+        }
+        av_audio_fifo_read(m_fifo.get(), reinterpret_cast<void**>(m_frame->extended_data), samples);
+
+        m_frame->pts = m_nextPts;
+        m_nextPts += samples;
+
+        if (!writePackets(m_frame.get())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LibavLiveEncoder::writePackets(const AVFrame* frame)
+{
+    int ret = avcodec_send_frame(m_encoder.get(), frame);
+    if (ret < 0) {
+        qWarning() << "Live encoder: Encoding failed:" << avError(ret);
+        return false;
+    }
+
+    while ((ret = avcodec_receive_packet(m_encoder.get(), m_packet.get())) >= 0) {
+        av_packet_rescale_ts(m_packet.get(), m_encoder->time_base, m_outStream->time_base);
+        m_packet->stream_index = m_outStream->index;
+        // Single stream, so no interleaving queue: each packet goes out now
+        ret = av_write_frame(m_output.get(), m_packet.get());
+        av_packet_unref(m_packet.get());
+        if (ret < 0) {
+            qWarning() << "Live encoder: Cannot write packet:" << avError(ret);
+            return false;
+        }
+    }
+
+    if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        qWarning() << "Live encoder: Encoding failed:" << avError(ret);
+        return false;
+    }
+    return true;
+}
+
+} // namespace Chromecast
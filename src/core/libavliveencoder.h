@@ -0,0 +1,79 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "libavhelpers.h"
+#include "liveencoder.h"
+
+#include <QByteArray>
+
+#include <vector>
+
+namespace Chromecast {
+
+/*!
+ * LiveEncoder built on libavcodec/libavformat. The muxer writes through a
+ * custom AVIO context straight into the LiveStream, one packet at a time.
+ */
+class LibavLiveEncoder : public LiveEncoder
+{
+public:
+    explicit LibavLiveEncoder(std::shared_ptr<LiveStream> stream);
+    ~LibavLiveEncoder() override;
+
+    static bool isFormatSupported(TranscodingFormat format);
+
+    bool open(TranscodingFormat format, TranscodingQuality quality, const Fooyin::AudioFormat& input, QString& error);
+
+    bool write(const char* data, int frames) override;
+    void finish() override;
+
+private:
+    static int writeOutput(void* opaque, Libav::IoBuffer data, int size);
+
+    bool encodeQueued(bool flush);
+    bool writePackets(const AVFrame* frame);
+
+    std::shared_ptr<LiveStream> m_stream;
+
+    Libav::OutputPtr m_output;
+    AVIOContext* m_io{nullptr};
+    AVStream* m_outStream{nullptr};
+    Libav::CodecPtr m_encoder;
+    Libav::ResamplerPtr m_resampler;
+    Libav::FifoPtr m_fifo;
+    Libav::FramePtr m_frame;
+    Libav::PacketPtr m_packet;
+    std::unique_ptr<Libav::SampleBuffer> m_converted;
+
+    QByteArray m_header;        // Collected while the muxer writes its header
+    bool m_headerWritten{false};
+
+    int m_inputChannels{0};
+    bool m_expand24{false};     // Input is 24-bit in 32, scaled up to full range
+    std::vector<int32_t> m_expanded;
+
+    int m_frameSize{0};
+    bool m_smallLastFrame{false};
+    int64_t m_nextPts{0};
+    bool m_open{false};
+    bool m_finished{false};
+};
+
+} // namespace Chromecast
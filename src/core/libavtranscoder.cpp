@@ -0,0 +1,936 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "libavtranscoder.h"
+
+#include "libavhelpers.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <thread>
+
+using namespace Chromecast::Libav;
+
+namespace {
+// Seconds of audio between progress reports
+constexpr double ProgressInterval = 1.0;
+// Shortest segment worth a thread of its own, in seconds
+constexpr double MinSegmentSeconds = 300.0;
+// Seconds a segment starts encoding ahead of its range, so the encoder has
+// settled by the first packet that is kept
+constexpr double SegmentPreroll = 0.5;
+// How long the output waits for the next packet of a segment before it
+// checks for cancellation again
+constexpr int SpoolWaitMs = 100;
+
+// Encoders whose packets can follow those of another instance of the same
+// encoder. libmp3lame needs its bit reservoir off for it (see openEncoder()).
+bool isJoinable(const QString& encoder)
+{
+    return encoder == u"aac" || encoder == u"libmp3lame" || encoder == u"libopus" || encoder.startsWith(u"pcm_");
+}
+
+int segmentCount(const Chromecast::LibavTranscoder::Request& request, double duration)
+{
+    if (request.threads < 2 || !isJoinable(request.encoder)) {
+        return 1;
+    }
+    return std::clamp(static_cast<int>(duration / MinSegmentSeconds), 1, request.threads);
+}
+
+// Encoded packets of one segment, spooled to disk by the thread encoding
+// the segment and read back in order by the thread writing the output
+class PacketSpool
+{
+public:
+    enum class Status
+    {
+        Packet,  // The next packet was read
+        Pending, // Nothing new yet
+        End,     // The segment is complete and every packet was read
+        Failed
+    };
+
+    explicit PacketSpool(const QString& path)
+        : m_writer{path}
+        , m_reader{path}
+    { }
+
+    ~PacketSpool()
+    {
+        m_writer.close();
+        m_reader.close();
+        QFile::remove(m_writer.fileName());
+    }
+
+    PacketSpool(const PacketSpool&)            = delete;
+    PacketSpool& operator=(const PacketSpool&) = delete;
+
+    bool open()
+    {
+        return m_writer.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            && m_reader.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    [[nodiscard]] QString fileName() const
+    {
+        return m_writer.fileName();
+    }
+
+    // Writer side
+    bool write(const AVPacket* packet)
+    {
+        const Header header{packet->pts, packet->dts, packet->duration, packet->flags, packet->size};
+        if (m_writer.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)
+            || m_writer.write(reinterpret_cast<const char*>(packet->data), packet->size) != packet->size
+            || !m_writer.flush()) {
+            return false;
+        }
+
+        const std::lock_guard lock{m_lock};
+        ++m_written;
+        m_changed.notify_one();
+        return true;
+    }
+
+    void finish(bool success, const QString& error)
+    {
+        const std::lock_guard lock{m_lock};
+        m_finished = true;
+        m_success  = success;
+        m_error    = error;
+        m_changed.notify_one();
+    }
+
+    // Reader side: waits up to timeoutMs for the next packet
+    Status read(AVPacket* packet, int timeoutMs)
+    {
+        {
+            std::unique_lock lock{m_lock};
+            m_changed.wait_for(lock, std::chrono::milliseconds{timeoutMs},
+                               [this]() { return m_read < m_written || m_finished; });
+            if (m_read == m_written) {
+                if (!m_finished) {
+                    return Status::Pending;
+                }
+                return m_success ? Status::End : Status::Failed;
+            }
+        }
+
+        // Complete on disk: it was flushed before it was counted
+        Header header;
+        if (!readFully(reinterpret_cast<char*>(&header), sizeof(header)) || av_new_packet(packet, header.size) < 0
+            || !readFully(reinterpret_cast<char*>(packet->data), header.size)) {
+            av_packet_unref(packet);
+            const std::lock_guard lock{m_lock};
+            m_error = QString("Cannot read back %1").arg(m_reader.fileName());
+            return Status::Failed;
+        }
+        packet->pts      = header.pts;
+        packet->dts      = header.dts;
+        packet->duration = header.duration;
+        packet->flags    = header.flags;
+        ++m_read;
+        return Status::Packet;
+    }
+
+    [[nodiscard]] QString error() const
+    {
+        const std::lock_guard lock{m_lock};
+        return m_error;
+    }
+
+private:
+    struct Header
+    {
+        int64_t pts;
+        int64_t dts;
+        int64_t duration;
+        int flags;
+        int size;
+    };
+
+    bool readFully(char* data, qint64 size)
+    {
+        while (size > 0) {
+            const qint64 read = m_reader.read(data, size);
+            if (read <= 0) {
+                return false;
+            }
+            data += read;
+            size -= read;
+        }
+        return true;
+    }
+
+    QFile m_writer;
+    QFile m_reader;
+    int64_t m_read{0}; // Only touched by the reader
+
+    mutable std::mutex m_lock;
+    std::condition_variable m_changed;
+    int64_t m_written{0};
+    bool m_finished{false};
+    bool m_success{false};
+    QString m_error;
+};
+} // namespace
+
+namespace Chromecast {
+
+// Decodes the source from a start time, resamples it and encodes it with
+// the encoder it is given, handing each packet to a sink
+class LibavTranscoder::Pipeline
+{
+public:
+    enum class SinkResult
+    {
+        Continue,
+        Done, // Nothing more is wanted; stops without draining the encoder
+        Failed
+    };
+
+    using Sink = std::function<SinkResult(AVPacket* packet, QString& error)>;
+
+    // Open sourcePath and seek it to startTime seconds
+    bool open(const QString& sourcePath, double startTime, QString& error);
+
+    [[nodiscard]] AVCodecContext* decoder() const
+    {
+        return m_decoder.get();
+    }
+
+    // Seconds from the start time to the end of the source, 0 if unknown
+    [[nodiscard]] double duration() const
+    {
+        return m_duration;
+    }
+
+    // Pts of the next sample to be encoded
+    [[nodiscard]] int64_t nextPts() const
+    {
+        return m_nextPts;
+    }
+
+    // Encode until the source ends or the sink is done. The first sample
+    // is stamped firstPts; tick is called for every source packet.
+    bool run(AVCodecContext* enc, int64_t firstPts, const Sink& sink, const Ticker& tick, QString& error);
+
+    // Samples per frame run() hands the encoder
+    static int frameSize(const AVCodecContext* enc);
+
+private:
+    bool decodePacket(const AVPacket* packet);
+    bool queueSamples(const AVFrame* frame, int skip);
+    bool encodeQueued(bool flush);
+    bool encodeFrame(const AVFrame* frame);
+
+    QString m_sourcePath;
+    InputPtr m_input;
+    CodecPtr m_decoder;
+    int m_streamIndex{-1};
+    const AVStream* m_stream{nullptr};
+    double m_duration{0.0};
+    // Decoded samples before this are dropped; AV_NOPTS_VALUE once the
+    // first sample is kept
+    int64_t m_startPts{AV_NOPTS_VALUE};
+
+    // Set up by run()
+    AVCodecContext* m_encoder{nullptr};
+    const Sink* m_sink{nullptr};
+    ResamplerPtr m_resampler;
+    FifoPtr m_fifo;
+    FramePtr m_decoded;
+    FramePtr m_encoded;
+    PacketPtr m_packet;
+    std::unique_ptr<SampleBuffer> m_converted;
+    std::vector<const uint8_t*> m_planes;
+    int m_frameSize{0};
+    bool m_smallLastFrame{false};
+    int64_t m_nextPts{0};
+    bool m_done{false};
+    QString m_error;
+};
+
+bool LibavTranscoder::Pipeline::open(const QString& sourcePath, double startTime, QString& error)
+{
+    m_sourcePath = sourcePath;
+
+    AVFormatContext* rawInput{nullptr};
+    int ret = avformat_open_input(&rawInput, sourcePath.toUtf8().constData(), nullptr, nullptr);
+    if (ret < 0) {
+        error = QString("Cannot open source: %1").arg(avError(ret));
+        return false;
+    }
+    m_input.reset(rawInput);
+
+    if ((ret = avformat_find_stream_info(m_input.get(), nullptr)) < 0) {
+        error = QString("Cannot read source: %1").arg(avError(ret));
+        return false;
+    }
+
+    const AVCodec* decoder{nullptr};
+    m_streamIndex = av_find_best_stream(m_input.get(), AVMEDIA_TYPE_AUDIO, -1, -1, &decoder, 0);
+    if (m_streamIndex < 0 || !decoder) {
+        error = "Source has no decodable audio stream";
+        return false;
+    }
+    m_stream = m_input->streams[m_streamIndex];
+
+    m_decoder.reset(avcodec_alloc_context3(decoder));
+    if (!m_decoder) {
+        error = "Out of memory";
+        return false;
+    }
+    avcodec_parameters_to_context(m_decoder.get(), m_stream->codecpar);
+    m_decoder->pkt_timebase = m_stream->time_base;
+    if ((ret = avcodec_open2(m_decoder.get(), decoder, nullptr)) < 0) {
+        error = QString("Cannot open decoder: %1").arg(avError(ret));
+        return false;
+    }
+    if (m_decoder->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+        const int channels = m_decoder->ch_layout.nb_channels;
+        av_channel_layout_uninit(&m_decoder->ch_layout);
+        av_channel_layout_default(&m_decoder->ch_layout, channels);
+    }
+
+    const double sourceDuration = m_input->duration != AV_NOPTS_VALUE
+                                    ? static_cast<double>(m_input->duration) / AV_TIME_BASE
+                                    : 0.0;
+    m_duration = std::max(0.0, sourceDuration - startTime);
+
+    // Lands on a packet at or before the start; decoded samples before
+    // m_startPts are dropped
+    if (startTime > 0.0) {
+        const int64_t origin = m_input->start_time != AV_NOPTS_VALUE ? m_input->start_time : 0;
+        const int64_t target = origin + std::llround(startTime * AV_TIME_BASE);
+        if ((ret = avformat_seek_file(m_input.get(), -1, INT64_MIN, target, target, 0)) < 0) {
+            error = QString("Cannot seek to %1 s: %2").arg(startTime).arg(avError(ret));
+            return false;
+        }
+        m_startPts = av_rescale_q(target, av_get_time_base_q(), m_stream->time_base);
+    }
+
+    return true;
+}
+
+int LibavTranscoder::Pipeline::frameSize(const AVCodecContext* enc)
+{
+    const bool variableFrames = (enc->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) || enc->frame_size <= 0;
+    return variableFrames ? VariableFrameSize : enc->frame_size;
+}
+
+bool LibavTranscoder::Pipeline::run(AVCodecContext* enc, int64_t firstPts, const Sink& sink, const Ticker& tick,
+                                    QString& error)
+{
+    m_encoder = enc;
+    m_sink    = &sink;
+    m_nextPts = firstPts;
+    m_done    = false;
+
+    // Resampler and frame queue between decoder and encoder
+    const AVCodecContext* dec = m_decoder.get();
+    SwrContext* rawResampler{nullptr};
+    int ret = swr_alloc_set_opts2(&rawResampler, &enc->ch_layout, enc->sample_fmt, enc->sample_rate, &dec->ch_layout,
+                                  dec->sample_fmt, dec->sample_rate, 0, nullptr);
+    m_resampler.reset(rawResampler);
+    if (ret >= 0) {
+        // Only takes effect where the output has fewer bits than the input
+        av_opt_set_int(m_resampler.get(), "dither_method", SWR_DITHER_TRIANGULAR_HIGHPASS, 0);
+    }
+    if (ret < 0 || (ret = swr_init(m_resampler.get())) < 0) {
+        error = QString("Cannot set up resampler: %1").arg(avError(ret));
+        return false;
+    }
+
+    const bool variableFrames = (enc->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) || enc->frame_size <= 0;
+    m_frameSize      = frameSize(enc);
+    m_smallLastFrame = variableFrames || (enc->codec->capabilities & AV_CODEC_CAP_SMALL_LAST_FRAME);
+
+    m_fifo.reset(av_audio_fifo_alloc(enc->sample_fmt, enc->ch_layout.nb_channels, m_frameSize));
+    m_decoded.reset(av_frame_alloc());
+    m_encoded.reset(av_frame_alloc());
+    m_packet.reset(av_packet_alloc());
+    m_converted = std::make_unique<SampleBuffer>(enc->ch_layout.nb_channels, enc->sample_fmt);
+    const PacketPtr inPacket{av_packet_alloc()};
+    if (!m_fifo || !m_decoded || !m_encoded || !m_packet || !inPacket) {
+        error = "Out of memory";
+        return false;
+    }
+
+    while (!m_done) {
+        if (!tick(m_nextPts)) {
+            error = "Cancelled";
+            return false;
+        }
+
+        ret = av_read_frame(m_input.get(), inPacket.get());
+        if (ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            error = QString("Cannot read source: %1").arg(avError(ret));
+            return false;
+        }
+
+        const bool ok = inPacket->stream_index != m_streamIndex || decodePacket(inPacket.get());
+        av_packet_unref(inPacket.get());
+        if (!ok) {
+            error = m_error;
+            return false;
+        }
+    }
+
+    // Each step is a no-op once the sink is done
+    if (!decodePacket(nullptr) || !queueSamples(nullptr, 0) || !encodeQueued(true) || !encodeFrame(nullptr)) {
+        error = m_error;
+        return false;
+    }
+    return true;
+}
+
+// Decode packet (nullptr drains the decoder). Damaged packets are skipped,
+// as the ffmpeg command line does.
+bool LibavTranscoder::Pipeline::decodePacket(const AVPacket* packet)
+{
+    if (m_done) {
+        return true;
+    }
+
+    int result = avcodec_send_packet(m_decoder.get(), packet);
+    if (result < 0 && result != AVERROR_EOF) {
+        qDebug() << "Skipping undecodable packet in" << m_sourcePath << avError(result);
+        return true;
+    }
+    while ((result = avcodec_receive_frame(m_decoder.get(), m_decoded.get())) >= 0) {
+        int skip{0};
+        if (m_startPts != AV_NOPTS_VALUE && m_decoded->best_effort_timestamp != AV_NOPTS_VALUE) {
+            const int64_t before = av_rescale_q(m_startPts - m_decoded->best_effort_timestamp, m_stream->time_base,
+                                                {1, m_decoded->sample_rate});
+            skip = static_cast<int>(std::clamp<int64_t>(before, 0, m_decoded->nb_samples));
+        }
+        if (skip < m_decoded->nb_samples) {
+            // Timestamps are only trusted up to the first frame kept
+            m_startPts = AV_NOPTS_VALUE;
+        }
+        const bool queued = skip >= m_decoded->nb_samples || queueSamples(m_decoded.get(), skip);
+        av_frame_unref(m_decoded.get());
+        if (!queued) {
+            return false;
+        }
+    }
+    if (result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
+        qDebug() << "Decoding error in" << m_sourcePath << avError(result);
+    }
+    return true;
+}
+
+// Resamples frame, less its first skip samples, into the queue; nullptr
+// drains the resampler
+bool LibavTranscoder::Pipeline::queueSamples(const AVFrame* frame, int skip)
+{
+    if (m_done) {
+        return true;
+    }
+
+    const int inSamples  = frame ? frame->nb_samples - skip : 0;
+    const int maxSamples = swr_get_out_samples(m_resampler.get(), inSamples);
+    if (maxSamples <= 0) {
+        return true;
+    }
+    uint8_t** buffer = m_converted->reserve(maxSamples);
+    if (!buffer) {
+        m_error = "Out of memory";
+        return false;
+    }
+    const uint8_t** in = frame ? const_cast<const uint8_t**>(frame->extended_data) : nullptr;
+    if (frame && skip > 0) {
+        const auto format   = static_cast<AVSampleFormat>(frame->format);
+        const int channels  = frame->ch_layout.nb_channels;
+        const bool planar   = av_sample_fmt_is_planar(format);
+        const int skipBytes = skip * av_get_bytes_per_sample(format) * (planar ? 1 : channels);
+        m_planes.assign(in, in + (planar ? channels : 1));
+        for (const uint8_t*& plane : m_planes) {
+            plane += skipBytes;
+        }
+        in = m_planes.data();
+    }
+    const int samples = swr_convert(m_resampler.get(), buffer, maxSamples, in, inSamples);
+    if (samples < 0) {
+        m_error = QString("Resampling failed: %1").arg(avError(samples));
+        return false;
+    }
+    if (samples > 0 && av_audio_fifo_write(m_fifo.get(), reinterpret_cast<void**>(buffer), samples) < samples) {
+        m_error = "Out of memory";
+        return false;
+    }
+    return encodeQueued(false);
+}
+
+bool LibavTranscoder::Pipeline::encodeQueued(bool flush)
+{
+    AVCodecContext* enc = m_encoder;
+    while (!m_done && (av_audio_fifo_size(m_fifo.get()) >= m_frameSize
+                       || (flush && av_audio_fifo_size(m_fifo.get()) > 0))) {
+        const int samples = std::min(av_audio_fifo_size(m_fifo.get()), m_frameSize);
+
+        av_frame_unref(m_encoded.get());
+        m_encoded->nb_samples  = m_smallLastFrame ? samples : m_frameSize;
+        m_encoded->format      = enc->sample_fmt;
+        m_encoded->sample_rate = enc->sample_rate;
+        av_channel_layout_copy(&m_encoded->ch_layout, &enc->ch_layout);
+        if (av_frame_get_buffer(m_encoded.get(), 0) < 0) {
+            m_error = "Out of memory";
+            return false;
+        }
+        if (m_encoded->nb_samples > samples) {
+            // Final partial frame of a fixed frame size encoder
+            av_samples_set_silence(m_encoded->extended_data, samples, m_encoded->nb_samples - samples,
+                                   enc->ch_layout.nb_channels, enc->sample_fmt);
+        }
+        av_audio_fifo_read(m_fifo.get(), reinterpret_cast<void**>(m_encoded->extended_data), samples);
+
+        m_encoded->pts = m_nextPts;
+        m_nextPts += samples;
+
+        if (!encodeFrame(m_encoded.get())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Encode frame (nullptr drains the encoder) and pass the packets to the sink
+bool LibavTranscoder::Pipeline::encodeFrame(const AVFrame* frame)
+{
+    if (m_done) {
+        return true;
+    }
+
+    int result = avcodec_send_frame(m_encoder, frame);
+    if (result < 0) {
+        m_error = QString("Encoding failed: %1").arg(avError(result));
+        return false;
+    }
+    while ((result = avcodec_receive_packet(m_encoder, m_packet.get())) >= 0) {
+        const SinkResult action = (*m_sink)(m_packet.get(), m_error);
+        av_packet_unref(m_packet.get());
+        if (action == SinkResult::Failed) {
+            return false;
+        }
+        if (action == SinkResult::Done) {
+            m_done = true;
+            return true;
+        }
+    }
+    if (result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
+        m_error = QString("Encoding failed: %1").arg(avError(result));
+        return false;
+    }
+    return true;
+}
+
+LibavTranscoder::LibavTranscoder() = default;
+
+LibavTranscoder::~LibavTranscoder()
+{
+    for (IdleEncoder& idle : m_idleEncoders) {
+        avcodec_free_context(&idle.context);
+    }
+}
+
+QString LibavTranscoder::version()
+{
+    return QString::fromUtf8(av_version_info());
+}
+
+AVCodecContext* LibavTranscoder::takeEncoder(const EncoderKey& key)
+{
+    const std::lock_guard lock{m_encoderLock};
+
+    const auto it = std::find_if(m_idleEncoders.begin(), m_idleEncoders.end(),
+                                 [&key](const IdleEncoder& idle) { return idle.key == key; });
+    if (it == m_idleEncoders.end()) {
+        return nullptr;
+    }
+
+    AVCodecContext* context = it->context;
+    m_idleEncoders.erase(it);
+    return context;
+}
+
+void LibavTranscoder::returnEncoder(const EncoderKey& key, AVCodecContext* context)
+{
+    // Most software audio encoders must be reopened after they are drained
+    if (!(context->codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH)) {
+        avcodec_free_context(&context);
+        return;
+    }
+
+    avcodec_flush_buffers(context);
+
+    const std::lock_guard lock{m_encoderLock};
+
+    if (m_idleEncoders.size() >= MaxIdleEncoders) {
+        avcodec_free_context(&m_idleEncoders.front().context);
+        m_idleEncoders.erase(m_idleEncoders.begin());
+    }
+    m_idleEncoders.push_back({key, context});
+}
+
+AVCodecContext* LibavTranscoder::openEncoder(const EncoderKey& key, bool joinable, QString& error)
+{
+    const AVCodec* encoder = avcodec_find_encoder_by_name(key.encoder.toUtf8().constData());
+    if (!encoder) {
+        error = QString("Encoder %1 is not available").arg(key.encoder);
+        return nullptr;
+    }
+
+    CodecPtr context{avcodec_alloc_context3(encoder)};
+    if (!context) {
+        error = "Out of memory";
+        return nullptr;
+    }
+    context->sample_rate = key.sampleRate;
+    context->sample_fmt  = static_cast<AVSampleFormat>(key.sampleFormat);
+    context->time_base   = {1, key.sampleRate};
+    av_channel_layout_default(&context->ch_layout, key.channels);
+    if (key.bitrate > 0) {
+        context->bit_rate = key.bitrate;
+    }
+    if (key.vbrQuality >= 0) {
+        context->flags |= AV_CODEC_FLAG_QSCALE;
+        context->global_quality = FF_QP2LAMBDA * key.vbrQuality;
+    }
+    if (key.globalHeader) {
+        context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    AVDictionary* options{nullptr};
+    if (joinable && key.encoder == u"libmp3lame") {
+        // With the reservoir an MP3 frame can begin in the frames before it,
+        // which aren't there when it is joined to another encoder's output
+        av_dict_set(&options, "reservoir", "0", 0);
+    }
+    const int ret = avcodec_open2(context.get(), encoder, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        error = QString("Cannot open encoder %1: %2").arg(key.encoder, avError(ret));
+        return nullptr;
+    }
+    return context.release();
+}
+
+bool LibavTranscoder::transcode(const Request& request, const std::atomic<bool>& cancelled, QString& error,
+                                const ProgressHandler& progress)
+{
+    Pipeline pipeline;
+    if (!pipeline.open(request.sourcePath, request.startTime, error)) {
+        return false;
+    }
+    const AVCodecContext* dec = pipeline.decoder();
+    const double duration     = pipeline.duration();
+
+    // Output; allocated before the encoder as the muxer decides where the
+    // codec headers go
+    AVFormatContext* rawOutput{nullptr};
+    const QByteArray outputPath = request.outputPath.toUtf8();
+    int ret = avformat_alloc_output_context2(&rawOutput, nullptr, request.muxer.toUtf8().constData(),
+                                             outputPath.constData());
+    if (ret < 0 || !rawOutput) {
+        error = QString("Cannot create %1 output: %2").arg(request.muxer, avError(ret));
+        return false;
+    }
+    const OutputPtr output{rawOutput};
+
+    // Encoder, reused from an earlier track when possible
+    const AVCodec* encoder = avcodec_find_encoder_by_name(request.encoder.toUtf8().constData());
+    if (!encoder) {
+        error = QString("Encoder %1 is not available").arg(request.encoder);
+        return false;
+    }
+
+    // The FLAC encoder writes s32 as 24-bit
+    const int sampleRate = request.sampleRate > 0 ? request.sampleRate : dec->sample_rate;
+    const int channels   = request.channels > 0 ? request.channels : dec->ch_layout.nb_channels;
+    AVSampleFormat sampleFormat = dec->sample_fmt;
+    if (request.bitDepth > 0) {
+        sampleFormat = request.bitDepth <= 16 ? AV_SAMPLE_FMT_S16 : AV_SAMPLE_FMT_S32;
+    }
+
+    EncoderKey key;
+    key.encoder      = request.encoder;
+    key.sampleRate   = chooseSampleRate(encoder, sampleRate);
+    key.channels     = std::min(channels, MaxChannels);
+    key.sampleFormat = chooseSampleFormat(encoder, sampleFormat);
+    key.bitrate      = request.bitrate;
+    key.vbrQuality   = request.vbrQuality;
+    key.globalHeader = output->oformat->flags & AVFMT_GLOBALHEADER;
+
+    CodecPtr encoderContext{takeEncoder(key)};
+    if (!encoderContext) {
+        encoderContext.reset(openEncoder(key, false, error));
+        if (!encoderContext) {
+            return false;
+        }
+    }
+    AVCodecContext* enc = encoderContext.get();
+
+    AVStream* outStream = avformat_new_stream(output.get(), nullptr);
+    if (!outStream) {
+        error = "Out of memory";
+        return false;
+    }
+    avcodec_parameters_from_context(outStream->codecpar, enc);
+    outStream->time_base = enc->time_base;
+
+    if ((ret = avio_open(&output->pb, outputPath.constData(), AVIO_FLAG_WRITE)) < 0) {
+        error = QString("Cannot open output file: %1").arg(avError(ret));
+        return false;
+    }
+    // Make the output readable while it is written
+    output->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+    if ((ret = avformat_write_header(output.get(), nullptr)) < 0) {
+        error = QString("Cannot write output header: %1").arg(avError(ret));
+        return false;
+    }
+
+    const PacketWriter write = [&output, outStream, enc](AVPacket* packet, QString& writeError) {
+        av_packet_rescale_ts(packet, enc->time_base, outStream->time_base);
+        packet->stream_index = outStream->index;
+        if (const int result = av_interleaved_write_frame(output.get(), packet); result < 0) {
+            writeError = QString("Cannot write output: %1").arg(avError(result));
+            return false;
+        }
+        return true;
+    };
+
+    int64_t encoded{0};
+    double reported{0.0};
+    const Ticker tick = [&](int64_t samples) {
+        if (cancelled) {
+            return false;
+        }
+        encoded = samples;
+        const double position = static_cast<double>(samples) / enc->sample_rate;
+        if (progress && position - reported >= ProgressInterval) {
+            reported = position;
+            progress(position, duration);
+        }
+        return true;
+    };
+
+    const int segments = segmentCount(request, duration);
+    if (request.threadsChosen) {
+        request.threadsChosen(segments);
+    }
+    if (segments > 1) {
+        qDebug() << "Encoding" << request.sourcePath << "in" << segments << "segments";
+        if (!encodeSegments(request, key, pipeline, enc, segments, write, tick, error)) {
+            return false;
+        }
+    } else {
+        const auto sink = [&write](AVPacket* packet, QString& writeError) {
+            return write(packet, writeError) ? Pipeline::SinkResult::Continue : Pipeline::SinkResult::Failed;
+        };
+        if (!pipeline.run(enc, 0, sink, tick, error)) {
+            return false;
+        }
+        encoded = pipeline.nextPts();
+    }
+
+    if ((ret = av_write_trailer(output.get())) < 0) {
+        error = QString("Cannot finish output: %1").arg(avError(ret));
+        return false;
+    }
+
+    if (progress) {
+        progress(static_cast<double>(encoded) / enc->sample_rate, duration);
+    }
+
+    returnEncoder(key, encoderContext.release());
+    return true;
+}
+
+bool LibavTranscoder::encodeSegments(const Request& request, const EncoderKey& key, Pipeline& first,
+                                     AVCodecContext* enc, int segments, const PacketWriter& write,
+                                     const Ticker& tick, QString& error)
+{
+    // Whole frames per segment, so the packets of every segment fall on
+    // the same grid and the joins need no padding
+    const int frameSize   = Pipeline::frameSize(enc);
+    const auto total      = static_cast<int64_t>(first.duration() * enc->sample_rate);
+    const int64_t frames  = (total + frameSize - 1) / frameSize;
+    const int64_t length  = (frames + segments - 1) / segments * frameSize;
+    const int64_t preroll = static_cast<int64_t>(std::ceil(SegmentPreroll * enc->sample_rate / frameSize)) * frameSize;
+    // Packets are stamped with their first sample's pts less the encoder delay
+    const int64_t delay = enc->initial_padding;
+
+    struct Segment
+    {
+        int64_t start{0};
+        int64_t end{-1}; // -1 for the last one, which runs to the end of the source
+        std::unique_ptr<PacketSpool> spool;
+        std::atomic<int64_t> nextPts{0};
+        std::thread thread;
+    };
+
+    std::vector<Segment> parts(static_cast<size_t>(segments));
+    for (size_t i = 0; i < parts.size(); ++i) {
+        parts[i].start = static_cast<int64_t>(i) * length;
+        parts[i].end   = i + 1 < parts.size() ? parts[i].start + length : -1;
+    }
+
+    // Stops the segment threads and waits for them however this returns
+    std::atomic<bool> stop{false};
+    struct Joiner
+    {
+        std::vector<Segment>& parts;
+        std::atomic<bool>& stop;
+
+        ~Joiner()
+        {
+            stop = true;
+            for (Segment& part : parts) {
+                if (part.thread.joinable()) {
+                    part.thread.join();
+                }
+            }
+        }
+    } joiner{parts, stop};
+
+    // Every segment after the first runs on a thread of its own, with its
+    // own input and encoder, and is spooled until the output reaches it
+    const auto encodeSegment = [&request, &key, &stop, enc, preroll, delay](Segment& part) {
+        if (request.threadStarted) {
+            request.threadStarted();
+        }
+        QString segmentError;
+        const bool ok = [&]() {
+            const int64_t firstPts = part.start - preroll;
+            Pipeline pipeline;
+            if (!pipeline.open(request.sourcePath,
+                               request.startTime + static_cast<double>(firstPts) / enc->sample_rate, segmentError)) {
+                return false;
+            }
+            const CodecPtr encoder{openEncoder(key, true, segmentError)};
+            if (!encoder) {
+                return false;
+            }
+
+            const auto keep = [&part, delay](AVPacket* packet, QString& packetError) {
+                const int64_t start = packet->pts + delay;
+                if (start < part.start) {
+                    return Pipeline::SinkResult::Continue;
+                }
+                if (part.end >= 0 && start >= part.end) {
+                    return Pipeline::SinkResult::Done;
+                }
+                if (!part.spool->write(packet)) {
+                    packetError = QString("Cannot write %1").arg(part.spool->fileName());
+                    return Pipeline::SinkResult::Failed;
+                }
+                return Pipeline::SinkResult::Continue;
+            };
+            const auto track = [&part, &stop](int64_t nextPts) {
+                part.nextPts = nextPts;
+                return !stop;
+            };
+
+            const bool encoded = pipeline.run(encoder.get(), firstPts, keep, track, segmentError);
+            part.nextPts       = pipeline.nextPts();
+            return encoded;
+        }();
+        part.spool->finish(ok, segmentError);
+        if (request.threadFinished) {
+            request.threadFinished();
+        }
+    };
+
+    for (size_t i = 1; i < parts.size(); ++i) {
+        Segment& part = parts[i];
+        part.spool    = std::make_unique<PacketSpool>(QString("%1.seg%2.part").arg(request.outputPath).arg(i));
+        if (!part.spool->open()) {
+            error = QString("Cannot create %1").arg(part.spool->fileName());
+            return false;
+        }
+        part.thread = std::thread{encodeSegment, std::ref(part)};
+    }
+
+    // Samples encoded by all segments together
+    const auto encodedSamples = [&parts, length](int64_t firstNextPts) {
+        int64_t samples = std::clamp<int64_t>(firstNextPts, 0, length);
+        for (size_t i = 1; i < parts.size(); ++i) {
+            const int64_t done = parts[i].nextPts - parts[i].start;
+            samples += parts[i].end >= 0 ? std::clamp<int64_t>(done, 0, length) : std::max<int64_t>(done, 0);
+        }
+        return samples;
+    };
+
+    // The first segment goes straight to the output, so it can be streamed
+    // while the others are still encoding
+    const Segment& head = parts.front();
+    const auto keepHead = [&head, &write, delay](AVPacket* packet, QString& packetError) {
+        if (packet->pts + delay >= head.end) {
+            return Pipeline::SinkResult::Done;
+        }
+        return write(packet, packetError) ? Pipeline::SinkResult::Continue : Pipeline::SinkResult::Failed;
+    };
+    const auto trackHead = [&tick, &encodedSamples](int64_t nextPts) {
+        return tick(encodedSamples(nextPts));
+    };
+    if (!first.run(enc, 0, keepHead, trackHead, error)) {
+        return false;
+    }
+
+    // Then the others in order, as they become available
+    const PacketPtr packet{av_packet_alloc()};
+    if (!packet) {
+        error = "Out of memory";
+        return false;
+    }
+    for (size_t i = 1; i < parts.size(); ++i) {
+        PacketSpool& spool = *parts[i].spool;
+        while (true) {
+            const PacketSpool::Status status = spool.read(packet.get(), SpoolWaitMs);
+            if (status == PacketSpool::Status::End) {
+                break;
+            }
+            if (status == PacketSpool::Status::Failed) {
+                error = QString("Segment %1 failed: %2").arg(i + 1).arg(spool.error());
+                return false;
+            }
+            if (status == PacketSpool::Status::Packet && !write(packet.get(), error)) {
+                return false;
+            }
+            if (!tick(encodedSamples(length))) {
+                error = "Cancelled";
+                return false;
+            }
+        }
+    }
+
+    tick(encodedSamples(length));
+    return true;
+}
+
+} // namespace Chromecast
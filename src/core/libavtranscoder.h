@@ -0,0 +1,139 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct AVCodecContext;
+struct AVPacket;
+
+namespace Chromecast {
+
+/*!
+ * In-process transcoder built on libavformat, libavcodec and libswresample.
+ *
+ * Does the work of the ffmpeg command line that TranscodingManager would
+ * otherwise spawn, without the process start and probe. Encoders that can
+ * be flushed are kept open after a track and reused by the next track with
+ * the same parameters; the others are reopened per track.
+ *
+ * A request can start part way into the source. The input is seeked to
+ * the nearest point before the start and the decoded samples up to it are
+ * dropped, so the output begins at the requested time exactly.
+ *
+ * The output can be limited to a lower sample rate, bit depth or channel
+ * count than the source's. Requantizing to fewer bits is dithered.
+ *
+ * A long source can be split into segments that are encoded on threads of
+ * their own and joined in order. Segments start on encoder frame
+ * boundaries and begin encoding a little early, keeping only the packets
+ * of their own range, so the joined stream is continuous. Only encoders
+ * whose packets can follow another encoder's take part; the rest always
+ * encode in one go.
+ *
+ * transcode() blocks and may be called from several threads at once.
+ */
+class LibavTranscoder
+{
+public:
+    struct Request
+    {
+        QString sourcePath;
+        QString outputPath;
+        QString muxer;       // e.g. "adts"
+        QString encoder;     // e.g. "aac"
+        int bitrate{0};      // bits/s, 0 when not bitrate controlled
+        int vbrQuality{-1};  // Encoder quality scale, -1 when unused
+        double startTime{0.0}; // Seconds into the source where the output starts
+        int threads{1};        // Segments of a long source that may be encoded at once
+        // Upper limits for the output, 0 to follow the source
+        int sampleRate{0};
+        int bitDepth{0};       // 16 or 24
+        int channels{0};
+        // Called from transcode() once the source is open, with the number
+        // of threads the encode will use (1 up to threads)
+        std::function<void(int threads)> threadsChosen;
+        // Called on each segment thread as it starts and right before it ends
+        std::function<void()> threadStarted;
+        std::function<void()> threadFinished;
+    };
+
+    // Seconds of audio encoded and the duration of the output (0 if unknown)
+    using ProgressHandler = std::function<void(double position, double duration)>;
+
+    LibavTranscoder();
+    ~LibavTranscoder();
+
+    LibavTranscoder(const LibavTranscoder&) = delete;
+    LibavTranscoder& operator=(const LibavTranscoder&) = delete;
+
+    // Returns false and sets error on failure or once cancelled is raised
+    bool transcode(const Request& request, const std::atomic<bool>& cancelled, QString& error,
+                   const ProgressHandler& progress = {});
+
+    static QString version();
+
+private:
+    class Pipeline;
+
+    // Writes a packet of the output; returns false and sets error on failure
+    using PacketWriter = std::function<bool(AVPacket* packet, QString& error)>;
+    // Told the samples encoded so far; returns false to cancel
+    using Ticker = std::function<bool(int64_t samples)>;
+
+    struct EncoderKey
+    {
+        QString encoder;
+        int sampleRate{0};
+        int channels{0};
+        int sampleFormat{0};
+        int bitrate{0};
+        int vbrQuality{-1};
+        bool globalHeader{false};
+
+        bool operator==(const EncoderKey& other) const = default;
+    };
+
+    struct IdleEncoder
+    {
+        EncoderKey key;
+        AVCodecContext* context{nullptr};
+    };
+
+    // joinable turns off encoder features that would break a join between segments
+    static AVCodecContext* openEncoder(const EncoderKey& key, bool joinable, QString& error);
+    static bool encodeSegments(const Request& request, const EncoderKey& key, Pipeline& first, AVCodecContext* enc,
+                               int segments, const PacketWriter& write, const Ticker& tick, QString& error);
+
+    AVCodecContext* takeEncoder(const EncoderKey& key);
+    void returnEncoder(const EncoderKey& key, AVCodecContext* context);
+
+    static constexpr size_t MaxIdleEncoders = 4;
+
+    std::mutex m_encoderLock;
+    std::vector<IdleEncoder> m_idleEncoders;
+};
+
+} // namespace Chromecast
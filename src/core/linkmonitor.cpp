@@ -0,0 +1,112 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "linkmonitor.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Weight of a new sample in the smoothed rate
+constexpr double SmoothingFactor = 0.3;
+// Stalls remembered per receiver
+constexpr size_t MaxStalls = 8;
+} // namespace
+
+namespace Chromecast {
+
+LinkMonitor::LinkMonitor()
+{
+    m_clock.start();
+}
+
+void LinkMonitor::addSample(const QHostAddress& peer, qint64 bytes, qint64 milliseconds)
+{
+    if (bytes <= 0 || milliseconds <= 0) {
+        return;
+    }
+
+    const double kbps = static_cast<double>(bytes) * 8.0 / static_cast<double>(milliseconds);
+
+    const QMutexLocker locker(&m_lock);
+    Entry& entry = m_links[key(peer)];
+    entry.throughput = entry.samples == 0 ? kbps : entry.throughput + SmoothingFactor * (kbps - entry.throughput);
+    ++entry.samples;
+
+    qDebug() << "Link to" << peer.toString() << ":" << qRound(kbps) << "kbit/s measured,"
+             << qRound(entry.throughput) << "kbit/s smoothed";
+}
+
+void LinkMonitor::addStall(const QHostAddress& peer)
+{
+    const QMutexLocker locker(&m_lock);
+    Entry& entry = m_links[key(peer)];
+    entry.stalls.push_back(m_clock.elapsed());
+    while (entry.stalls.size() > MaxStalls) {
+        entry.stalls.pop_front();
+    }
+
+    qInfo() << "Link to" << peer.toString() << "stalled," << recentStalls(entry) << "recent stalls";
+}
+
+LinkMonitor::Link LinkMonitor::link(const QHostAddress& peer) const
+{
+    const QMutexLocker locker(&m_lock);
+    const auto it = m_links.constFind(key(peer));
+    if (it == m_links.cend()) {
+        return {};
+    }
+    return {it->throughput, it->samples, recentStalls(*it)};
+}
+
+int LinkMonitor::sustainableBitrate(const QHostAddress& peer) const
+{
+    const Link current = link(peer);
+    if (current.samples == 0 && current.recentStalls == 0) {
+        return 0;
+    }
+
+    // A link that stalled before any full measurement gets a modest start
+    const double measured = current.samples > 0 ? current.throughput : 512.0 * Headroom;
+    return static_cast<int>(measured / Headroom / std::pow(2.0, current.recentStalls));
+}
+
+void LinkMonitor::clear()
+{
+    const QMutexLocker locker(&m_lock);
+    m_links.clear();
+}
+
+QString LinkMonitor::key(const QHostAddress& peer)
+{
+    bool isIpv4{false};
+    const quint32 ipv4 = peer.toIPv4Address(&isIpv4);
+    return isIpv4 ? QHostAddress(ipv4).toString() : peer.toString();
+}
+
+int LinkMonitor::recentStalls(const Entry& entry) const
+{
+    const qint64 since = m_clock.elapsed() - StallWindowMs;
+    return static_cast<int>(std::count_if(entry.stalls.cbegin(), entry.stalls.cend(),
+                                          [since](qint64 stall) { return stall >= since; }));
+}
+
+} // namespace Chromecast
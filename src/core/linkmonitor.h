@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QMutex>
+
+#include <deque>
+
+namespace Chromecast {
+
+/*!
+ * Thread-safe record of how fast the HTTP server can send to each receiver.
+ *
+ * HTTP connections report the send rate of the start of every response,
+ * when receivers read as fast as the link allows to fill their buffer, and
+ * any stall where nothing drained for a while in that phase. Rates are
+ * smoothed per receiver address, so each device keeps its own history for
+ * as long as the plugin runs.
+ *
+ * sustainableBitrate() turns that into the highest encoded bitrate worth
+ * sending: a fraction of the measured rate, halved for every recent stall.
+ */
+class LinkMonitor
+{
+public:
+    // Measured rate divided by this is left for the audio
+    static constexpr double Headroom = 2.0;
+    // Stalls older than this no longer count
+    static constexpr qint64 StallWindowMs = 10 * 60 * 1000;
+
+    struct Link
+    {
+        double throughput{0.0}; // kbit/s, smoothed; 0 if never measured
+        int samples{0};
+        int recentStalls{0};
+    };
+
+    LinkMonitor();
+
+    void addSample(const QHostAddress& peer, qint64 bytes, qint64 milliseconds);
+    void addStall(const QHostAddress& peer);
+
+    [[nodiscard]] Link link(const QHostAddress& peer) const;
+    // Highest bitrate in kbit/s to encode for peer, 0 if unknown
+    [[nodiscard]] int sustainableBitrate(const QHostAddress& peer) const;
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        double throughput{0.0};
+        int samples{0};
+        std::deque<qint64> stalls; // m_clock msecs, oldest first
+    };
+
+    // IPv4-mapped IPv6 peers are stored under their IPv4 address
+    static QString key(const QHostAddress& peer);
+    int recentStalls(const Entry& entry) const;
+
+    mutable QMutex m_lock;
+    QElapsedTimer m_clock;
+    QHash<QString, Entry> m_links;
+};
+
+} // namespace Chromecast
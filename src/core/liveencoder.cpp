@@ -0,0 +1,71 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "liveencoder.h"
+
+#include "livestream.h"
+#include "pcmliveencoder.h"
+#include "transcodingmanager.h"
+
+#ifdef CHROMECAST_HAVE_LIBAV
+#include "libavliveencoder.h"
+#endif
+
+namespace Chromecast {
+
+bool LiveEncoder::isFormatAvailable(TranscodingFormat format)
+{
+    if (format == TranscodingFormat::WAV) {
+        return true;
+    }
+
+#ifdef CHROMECAST_HAVE_LIBAV
+    return LibavLiveEncoder::isFormatSupported(format);
+#else
+    Q_UNUSED(format)
+    return false;
+#endif
+}
+
+std::unique_ptr<LiveEncoder> LiveEncoder::create(const Options& options, const Fooyin::AudioFormat& input,
+                                                 std::shared_ptr<LiveStream> stream, QString& error)
+{
+    if (options.format == TranscodingFormat::WAV) {
+        if (!PcmLiveEncoder::isInputSupported(input)) {
+            error = "Unsupported input audio format";
+            return {};
+        }
+        return std::make_unique<PcmLiveEncoder>(std::move(stream), input, options.pcmBitsPerSample);
+    }
+
+#ifdef CHROMECAST_HAVE_LIBAV
+    if (LibavLiveEncoder::isFormatSupported(options.format)) {
+        auto encoder = std::make_unique<LibavLiveEncoder>(std::move(stream));
+        if (!encoder->open(options.format, options.quality, input, error)) {
+            return {};
+        }
+        return encoder;
+    }
+#endif
+
+    error = QString("Live encoding to %1 is not available in this build")
+                .arg(TranscodingManager::fileExtension(options.format).toUpper());
+    return {};
+}
+
+} // namespace Chromecast
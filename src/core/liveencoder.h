@@ -0,0 +1,67 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <chromecast/chromecast_common.h>
+
+#include <QString>
+
+#include <memory>
+
+namespace Fooyin {
+class AudioFormat;
+}
+
+namespace Chromecast {
+
+class LiveStream;
+
+/*!
+ * Encodes the PCM that the audio engine hands to ChromecastOutput into a
+ * LiveStream as it arrives, so anything Fooyin can decode (after its DSP
+ * chain) can be cast without decoding the file a second time.
+ *
+ * Called from the audio thread only.
+ */
+class LiveEncoder
+{
+public:
+    virtual ~LiveEncoder() = default;
+
+    // Encode frames of interleaved PCM in the format given to create()
+    virtual bool write(const char* data, int frames) = 0;
+    // Encode anything still buffered and end the stream
+    virtual void finish() = 0;
+
+    struct Options
+    {
+        TranscodingFormat format{TranscodingFormat::FLAC};
+        TranscodingQuality quality{TranscodingQuality::High};
+        int pcmBitsPerSample{16}; // WAV output, 16 or 24
+    };
+
+    // Formats create() can produce in this build
+    static bool isFormatAvailable(TranscodingFormat format);
+    // Returns nullptr and sets error if the encoder can't be set up.
+    // WAV is never encoded, only wrapped (PcmLiveEncoder).
+    static std::unique_ptr<LiveEncoder> create(const Options& options, const Fooyin::AudioFormat& input,
+                                               std::shared_ptr<LiveStream> stream, QString& error);
+};
+
+} // namespace Chromecast
@@ -0,0 +1,166 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "livestream.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace Chromecast {
+
+LiveStream::LiveStream(qint64 backlogMs, qint64 backlogBytes)
+    : m_maxBacklogBytes(backlogBytes)
+    , m_maxBacklogMs(backlogMs)
+{
+    m_clock.start();
+}
+
+void LiveStream::setHeader(const QByteArray& header)
+{
+    const QMutexLocker locker(&m_lock);
+    m_header = header;
+    m_hasHeader = true;
+    m_bytesWritten += header.size();
+}
+
+void LiveStream::append(const QByteArray& packet, bool syncPoint)
+{
+    if (packet.isEmpty()) {
+        return;
+    }
+
+    const QMutexLocker locker(&m_lock);
+
+    const qint64 now = m_clock.elapsed();
+    m_packets.push_back({packet, now, syncPoint});
+    m_backlogBytes += packet.size();
+    m_bytesWritten += packet.size();
+
+    // Always keep the newest packet, however large or old. Until the
+    // receiver connects, everything since the start waits for it.
+    while (m_packets.size() > 1
+           && (m_backlogBytes > m_maxBacklogBytes
+               || (m_readerJoined && now - m_packets.front().time > m_maxBacklogMs))) {
+        m_backlogBytes -= m_packets.front().data.size();
+        m_packets.pop_front();
+        ++m_firstPacket;
+    }
+}
+
+void LiveStream::finish()
+{
+    const QMutexLocker locker(&m_lock);
+    m_finished = true;
+    // Readers waiting for a header that never came end with an empty body
+    m_hasHeader = true;
+}
+
+bool LiveStream::isFinished() const
+{
+    const QMutexLocker locker(&m_lock);
+    return m_finished;
+}
+
+qint64 LiveStream::read(Reader& reader, char* data, qint64 maxSize)
+{
+    const QMutexLocker locker(&m_lock);
+
+    if (!m_hasHeader) {
+        return 0;
+    }
+
+    qint64 copied{0};
+
+    if (reader.headerOffset < m_header.size()) {
+        const qint64 count = std::min<qint64>(m_header.size() - reader.headerOffset, maxSize);
+        std::memcpy(data, m_header.constData() + reader.headerOffset, count);
+        reader.headerOffset += count;
+        copied += count;
+    }
+
+    if (!reader.joined) {
+        // The first reader takes the stream from its start
+        const std::optional<quint64> start = m_readerJoined ? joinPoint() : firstSyncPoint();
+        if (!start) {
+            return copied;
+        }
+        reader.packet = *start;
+        reader.joined = true;
+        m_readerJoined = true;
+    }
+
+    if (reader.packet < m_firstPacket) {
+        // Skipping ahead would corrupt the packet it is part way through
+        qWarning() << "LiveStream: Reader fell more than" << m_maxBacklogMs << "ms behind";
+        return -1;
+    }
+
+    const quint64 endPacket = m_firstPacket + m_packets.size();
+    while (copied < maxSize && reader.packet < endPacket) {
+        const QByteArray& packet = m_packets[reader.packet - m_firstPacket].data;
+        const qint64 count = std::min<qint64>(packet.size() - reader.packetOffset, maxSize - copied);
+        std::memcpy(data + copied, packet.constData() + reader.packetOffset, count);
+        copied += count;
+        reader.packetOffset += count;
+        if (reader.packetOffset == packet.size()) {
+            ++reader.packet;
+            reader.packetOffset = 0;
+        }
+    }
+
+    return copied;
+}
+
+std::optional<quint64> LiveStream::joinPoint() const
+{
+    const qint64 now = m_clock.elapsed();
+
+    // The oldest sync point within the lead, else the newest one there is
+    std::optional<quint64> start;
+    for (auto it = m_packets.crbegin(); it != m_packets.crend(); ++it) {
+        if (start && now - it->time > JoinLeadMs) {
+            break;
+        }
+        if (it->syncPoint) {
+            start = m_firstPacket + static_cast<quint64>(std::distance(it, m_packets.crend()) - 1);
+        }
+    }
+    return start;
+}
+
+std::optional<quint64> LiveStream::firstSyncPoint() const
+{
+    const auto it = std::find_if(m_packets.cbegin(), m_packets.cend(), [](const Packet& packet) {
+        return packet.syncPoint;
+    });
+    if (it == m_packets.cend()) {
+        return {};
+    }
+    return m_firstPacket + static_cast<quint64>(std::distance(m_packets.cbegin(), it));
+}
+
+qint64 LiveStream::bytesWritten() const
+{
+    const QMutexLocker locker(&m_lock);
+    return m_bytesWritten;
+}
+
+} // namespace Chromecast
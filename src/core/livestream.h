@@ -0,0 +1,108 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include <deque>
+#include <optional>
+
+namespace Chromecast {
+
+/*!
+ * Encoded audio produced while it is being played, for the HTTP server to
+ * stream to any number of receivers.
+ *
+ * The writer sets a header (container and codec setup) and then appends
+ * whole packets, marking those a decoder can start at. Every reader gets
+ * the header first. The first reader then starts at the oldest packet, so
+ * the receiver plays the track from where the writer began; later readers
+ * join at a sync point near the newest packet, so a receiver that
+ * reconnects hears what is playing now rather than a backlog. Packets are
+ * kept for backlogMs (at most backlogBytes), and none age out before the
+ * first reader has joined; a reader that falls further behind is cut off.
+ *
+ * Thread-safe: written from the audio thread, read from HTTP workers.
+ */
+class LiveStream
+{
+public:
+    // Position of one reader in the stream
+    struct Reader
+    {
+        qsizetype headerOffset{0};
+        bool joined{false};
+        quint64 packet{0};        // Sequence number of the next packet
+        qsizetype packetOffset{0};
+    };
+
+    static constexpr qint64 DefaultBacklogBytes = 4LL * 1024 * 1024;
+    static constexpr qint64 DefaultBacklogMs = 5000;
+    // A new reader starts up to this far behind the newest packet, so the
+    // receiver has a little to buffer before it plays at the live rate
+    static constexpr qint64 JoinLeadMs = 500;
+
+    // Packets older than backlogMs are dropped, and the oldest ones
+    // whenever more than backlogBytes are kept
+    explicit LiveStream(qint64 backlogMs = DefaultBacklogMs, qint64 backlogBytes = DefaultBacklogBytes);
+
+    // Readers wait for the header before receiving anything
+    void setHeader(const QByteArray& header);
+    // syncPoint: a decoder can start at this packet
+    void append(const QByteArray& packet, bool syncPoint = true);
+    // No more data will be appended
+    void finish();
+    [[nodiscard]] bool isFinished() const;
+
+    // Copy up to maxSize bytes from the reader's position and advance it.
+    // Returns 0 if there is nothing new, -1 if the reader fell behind.
+    qint64 read(Reader& reader, char* data, qint64 maxSize);
+
+    [[nodiscard]] qint64 bytesWritten() const;
+
+private:
+    struct Packet
+    {
+        QByteArray data;
+        qint64 time{0};       // m_clock when appended
+        bool syncPoint{true};
+    };
+
+    // Sequence number a new reader starts at, none until there is a sync point
+    std::optional<quint64> joinPoint() const;
+    // Sequence number of the oldest packet a decoder can start at
+    std::optional<quint64> firstSyncPoint() const;
+
+    mutable QMutex m_lock;
+    QElapsedTimer m_clock;
+    QByteArray m_header;
+    bool m_hasHeader{false};
+    std::deque<Packet> m_packets;
+    quint64 m_firstPacket{0};     // Sequence number of m_packets.front()
+    qint64 m_backlogBytes{0};     // Bytes in m_packets
+    qint64 m_maxBacklogBytes;
+    qint64 m_maxBacklogMs;
+    bool m_readerJoined{false};   // Packets only age out after this
+    qint64 m_bytesWritten{0};
+    bool m_finished{false};
+};
+
+} // namespace Chromecast
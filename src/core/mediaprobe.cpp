@@ -0,0 +1,190 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "mediaprobe.h"
+
+#ifdef CHROMECAST_HAVE_LIBAV
+#include "libavhelpers.h"
+#endif
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+// Time ffprobe gets to read a file
+constexpr int ProbeTimeoutMs = 5000;
+
+// "mov,mp4,m4a,3gp,3g2,mj2" -> "mp4", "matroska,webm" -> "matroska"
+QString containerName(const QString& formatName)
+{
+    const QString name = formatName.section(u',', 0, 0);
+    return name == u"mov" ? QStringLiteral("mp4") : name;
+}
+
+#ifdef CHROMECAST_HAVE_LIBAV
+Chromecast::MediaInfo probeWithLibav(const QString& filePath)
+{
+    using namespace Chromecast::Libav;
+
+    Chromecast::MediaInfo info;
+
+    AVFormatContext* rawInput{nullptr};
+    if (avformat_open_input(&rawInput, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return info;
+    }
+    const InputPtr input{rawInput};
+    if (avformat_find_stream_info(input.get(), nullptr) < 0) {
+        return info;
+    }
+
+    const int streamIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        return info;
+    }
+    const AVCodecParameters* params = input->streams[streamIndex]->codecpar;
+
+    info.container  = containerName(QString::fromUtf8(input->iformat->name));
+    info.codec      = QString::fromUtf8(avcodec_get_name(params->codec_id));
+    info.sampleRate = params->sample_rate;
+    info.channels   = params->ch_layout.nb_channels;
+    info.bitDepth   = params->bits_per_raw_sample > 0 ? params->bits_per_raw_sample : params->bits_per_coded_sample;
+    info.bitrate    = static_cast<int>(std::max<int64_t>(params->bit_rate > 0 ? params->bit_rate : input->bit_rate, 0)
+                                    / 1000);
+    return info;
+}
+#else
+Chromecast::MediaInfo probeWithFfprobe(const QString& filePath)
+{
+    Chromecast::MediaInfo info;
+
+    QProcess process;
+    process.start("ffprobe", {"-v", "error", "-select_streams", "a:0", "-show_entries",
+                              "format=format_name,bit_rate:stream=codec_name,sample_rate,channels,bits_per_raw_sample,"
+                              "bits_per_sample",
+                              "-of", "default=noprint_wrappers=1", filePath});
+    if (!process.waitForFinished(ProbeTimeoutMs) || process.exitStatus() != QProcess::NormalExit
+        || process.exitCode() != 0) {
+        return info;
+    }
+
+    // One key=value per line; N/A for unknown values, which read as 0
+    int bitsPerSample{0};
+    const QStringList lines = QString::fromUtf8(process.readAllStandardOutput()).split(u'\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        const QString key   = line.section(u'=', 0, 0);
+        const QString value = line.section(u'=', 1).trimmed();
+        if (key == u"codec_name") {
+            info.codec = value;
+        } else if (key == u"sample_rate") {
+            info.sampleRate = value.toInt();
+        } else if (key == u"channels") {
+            info.channels = value.toInt();
+        } else if (key == u"bits_per_raw_sample") {
+            info.bitDepth = value.toInt();
+        } else if (key == u"bits_per_sample") {
+            bitsPerSample = value.toInt();
+        } else if (key == u"format_name") {
+            info.container = containerName(value);
+        } else if (key == u"bit_rate") {
+            info.bitrate = static_cast<int>(value.toLongLong() / 1000);
+        }
+    }
+    if (info.bitDepth <= 0) {
+        info.bitDepth = bitsPerSample;
+    }
+    return info;
+}
+#endif
+} // namespace
+
+namespace Chromecast {
+
+bool MediaInfo::isLossless() const
+{
+    static const QStringList LosslessCodecs
+        = {"flac", "alac", "ape", "wavpack", "tta", "tak", "shorten", "mlp", "truehd", "wmalossless"};
+    return codec.startsWith(u"pcm_") || LosslessCodecs.contains(codec);
+}
+
+MediaInfo MediaProbe::probe(const QString& filePath)
+{
+    const QFileInfo file{filePath};
+    if (!file.isFile()) {
+        return {};
+    }
+    const qint64 size        = file.size();
+    const QDateTime modified = file.lastModified();
+
+    {
+        const QMutexLocker locker(&m_lock);
+        const auto it = m_entries.constFind(filePath);
+        if (it != m_entries.cend() && it->size == size && it->modified == modified) {
+            return it->info;
+        }
+    }
+
+    // Unlocked, so a slow file doesn't hold up lookups of cached ones
+    const MediaInfo info = probeFile(filePath);
+    if (info.isValid()) {
+        qDebug() << "Probed" << filePath << ":" << info.codec << "in" << info.container << info.sampleRate << "Hz"
+                 << info.bitDepth << "bit" << info.channels << "channels" << info.bitrate << "kbit/s";
+    } else {
+        qDebug() << "Cannot probe" << filePath;
+    }
+
+    // Failures are cached too, so an unreadable file isn't probed on every call
+    const QMutexLocker locker(&m_lock);
+    if (m_entries.size() >= MaxEntries) {
+        m_entries.clear();
+    }
+    m_entries.insert(filePath, {size, modified, info});
+    return info;
+}
+
+bool MediaProbe::isCached(const QString& filePath)
+{
+    const QFileInfo file{filePath};
+    if (!file.isFile()) {
+        return true; // probe() gives up at once
+    }
+
+    const QMutexLocker locker(&m_lock);
+    const auto it = m_entries.constFind(filePath);
+    return it != m_entries.cend() && it->size == file.size() && it->modified == file.lastModified();
+}
+
+void MediaProbe::clear()
+{
+    const QMutexLocker locker(&m_lock);
+    m_entries.clear();
+}
+
+MediaInfo MediaProbe::probeFile(const QString& filePath)
+{
+#ifdef CHROMECAST_HAVE_LIBAV
+    return probeWithLibav(filePath);
+#else
+    return probeWithFfprobe(filePath);
+#endif
+}
+
+} // namespace Chromecast
@@ -0,0 +1,79 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+namespace Chromecast {
+
+// Codec and stream parameters of the audio in a file
+struct MediaInfo
+{
+    QString container; // Demuxer name, e.g. "mp4", "flac", "ogg"
+    QString codec;     // ffmpeg codec name, e.g. "aac", "alac", "pcm_s24le"
+    int sampleRate{0};
+    int bitDepth{0};   // 0 for lossy codecs or when unknown
+    int channels{0};
+    int bitrate{0};    // kbit/s, 0 if unknown
+
+    [[nodiscard]] bool isValid() const
+    {
+        return !codec.isEmpty();
+    }
+    [[nodiscard]] bool isLossless() const;
+};
+
+/*!
+ * Reads the codec, sample rate and bit depth of audio files, with
+ * libavformat when the plugin is built with it, else with ffprobe.
+ *
+ * Results are cached per file and reused until its size or modification
+ * time changes, so asking again for every track change and lookahead is
+ * cheap. Thread-safe.
+ */
+class MediaProbe
+{
+public:
+    // Invalid MediaInfo if the file can't be read
+    MediaInfo probe(const QString& filePath);
+    // Whether probe() would answer from the cache without reading the file
+    bool isCached(const QString& filePath);
+    void clear();
+
+private:
+    struct Entry
+    {
+        qint64 size{0};
+        QDateTime modified;
+        MediaInfo info;
+    };
+
+    static MediaInfo probeFile(const QString& filePath);
+
+    // Dropped wholesale beyond this; a library is rarely cast from that widely
+    static constexpr int MaxEntries = 4096;
+
+    QMutex m_lock;
+    QHash<QString, Entry> m_entries;
+};
+
+} // namespace Chromecast
@@ -0,0 +1,226 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "mediaregistry.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// How often unretained entries are checked for expiry
+constexpr qint64 ExpiryIntervalMs = 60 * 1000;
+constexpr int FileIdLength = 16; // Hex digits
+
+const QString MediaPrefix = QStringLiteral("/media/");
+const QString CoverPrefix = QStringLiteral("/cover/");
+const QString CoverSuffix = QStringLiteral("jpg");
+
+QString fileIdString(quint64 id)
+{
+    return QString::number(id, 16).rightJustified(FileIdLength, QLatin1Char('0'));
+}
+} // namespace
+
+namespace Chromecast {
+
+MediaRegistry::MediaRegistry()
+{
+    m_clock.start();
+}
+
+QString MediaRegistry::addMedia(const QString& filePath)
+{
+    add(filePath, Media);
+    return QString("%1%2.%3").arg(MediaPrefix, fileIdString(fileId(filePath)), QFileInfo(filePath).suffix());
+}
+
+QString MediaRegistry::addCover(const QString& mediaPath)
+{
+    // Stores the media path, not a cover path - covers are extracted on demand
+    add(mediaPath, Cover);
+    return QString("%1%2.%3").arg(CoverPrefix, fileIdString(fileId(mediaPath)), CoverSuffix);
+}
+
+QString MediaRegistry::mediaPath(const QString& urlPath) const
+{
+    return lookup(urlPath, Media);
+}
+
+QString MediaRegistry::coverPath(const QString& urlPath) const
+{
+    return lookup(urlPath, Cover);
+}
+
+void MediaRegistry::retain(Holder holder, const QStringList& filePaths)
+{
+    QSet<quint64> retained;
+    retained.reserve(filePaths.size());
+    for (const QString& filePath : filePaths) {
+        if (!filePath.isEmpty()) {
+            retained.insert(fileId(filePath));
+        }
+    }
+
+    const QWriteLocker locker(&m_lock);
+    m_held[static_cast<size_t>(holder)] = std::move(retained);
+    m_retained.clear();
+    for (const QSet<quint64>& held : m_held) {
+        m_retained.unite(held);
+    }
+}
+
+void MediaRegistry::clear()
+{
+    const QWriteLocker locker(&m_lock);
+    m_entries.clear();
+    for (QSet<quint64>& held : m_held) {
+        held.clear();
+    }
+    m_retained.clear();
+}
+
+MediaRegistry::Stats MediaRegistry::stats() const
+{
+    const QReadLocker locker(&m_lock);
+
+    Stats stats;
+    stats.entries = static_cast<qsizetype>(m_entries.size());
+    stats.expired = m_expired;
+    for (const auto& [id, entry] : m_entries) {
+        stats.pathBytes += entry.path.size() * static_cast<qint64>(sizeof(QChar));
+        if (m_retained.contains(id)) {
+            ++stats.retained;
+        }
+    }
+    return stats;
+}
+
+quint64 MediaRegistry::fileId(const QString& filePath)
+{
+    // First 64 bits of the MD5, matching the hex IDs used in URLs
+    const QByteArray hash = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Md5);
+    return qFromBigEndian<quint64>(hash.constData());
+}
+
+bool MediaRegistry::parseUrl(QStringView urlPath, QStringView prefix, quint64& id, QStringView& suffix)
+{
+    if (!urlPath.startsWith(prefix) || urlPath.size() < prefix.size() + FileIdLength + 1) {
+        return false;
+    }
+
+    const QStringView rest = urlPath.sliced(prefix.size());
+    if (rest.at(FileIdLength) != QLatin1Char('.')) {
+        return false;
+    }
+
+    bool ok{false};
+    id = rest.first(FileIdLength).toULongLong(&ok, 16);
+    suffix = rest.sliced(FileIdLength + 1);
+    return ok;
+}
+
+void MediaRegistry::add(const QString& filePath, Kind kind)
+{
+    const quint64 id = fileId(filePath);
+
+    const QWriteLocker locker(&m_lock);
+
+    auto [it, inserted] = m_entries.try_emplace(id);
+    Entry& entry = it->second;
+    if (inserted) {
+        entry.path = filePath;
+    }
+    entry.kinds |= kind;
+    entry.lastUsed.store(m_clock.elapsed(), std::memory_order_relaxed);
+
+    if (static_cast<qsizetype>(m_entries.size()) > MaxEntries || m_clock.elapsed() - m_lastExpiry > ExpiryIntervalMs) {
+        expire();
+    }
+}
+
+QString MediaRegistry::lookup(const QString& urlPath, Kind kind) const
+{
+    quint64 id{0};
+    QStringView suffix;
+    if (!parseUrl(urlPath, kind == Media ? MediaPrefix : CoverPrefix, id, suffix)) {
+        return {};
+    }
+
+    const QReadLocker locker(&m_lock);
+
+    const auto it = m_entries.find(id);
+    if (it == m_entries.cend() || !(it->second.kinds & kind)) {
+        return {};
+    }
+
+    const Entry& entry = it->second;
+    if (kind == Cover ? suffix != CoverSuffix : suffix != QFileInfo(entry.path).suffix()) {
+        return {};
+    }
+
+    entry.lastUsed.store(m_clock.elapsed(), std::memory_order_relaxed);
+    return entry.path;
+}
+
+void MediaRegistry::expire()
+{
+    // Called with the write lock held
+    const qint64 now = m_clock.elapsed();
+    m_lastExpiry = now;
+
+    const size_t sizeBefore = m_entries.size();
+
+    std::vector<std::pair<qint64, quint64>> candidates; // (lastUsed, id)
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (m_retained.contains(it->first)) {
+            ++it;
+            continue;
+        }
+        const qint64 lastUsed = it->second.lastUsed.load(std::memory_order_relaxed);
+        if (now - lastUsed > EntryTtlMs) {
+            it = m_entries.erase(it);
+            continue;
+        }
+        candidates.emplace_back(lastUsed, it->first);
+        ++it;
+    }
+
+    // Still over budget: drop the least recently used unretained entries
+    const auto excess = static_cast<qsizetype>(m_entries.size()) - MaxEntries;
+    if (excess > 0) {
+        const auto count = std::min(static_cast<size_t>(excess), candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(count),
+                          candidates.end());
+        for (size_t i = 0; i < count; ++i) {
+            m_entries.erase(candidates[i].second);
+        }
+    }
+
+    const size_t dropped = sizeBefore - m_entries.size();
+    if (dropped > 0) {
+        m_expired += dropped;
+        qDebug() << "Media registry: expired" << dropped << "entries," << m_entries.size() << "remaining";
+    }
+}
+
+} // namespace Chromecast
@@ -0,0 +1,113 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QElapsedTimer>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+namespace Chromecast {
+
+/*!
+ * Thread-safe, bounded mapping of HTTP URL paths to local files.
+ *
+ * Media and cover URLs for a file share one entry keyed by a 64-bit hash of
+ * its path, so each path is stored exactly once however many URLs point at
+ * it. URLs are registered from the plugin thread and looked up by every HTTP
+ * worker thread on each request, so lookups take a shared lock and only
+ * registration takes the exclusive one.
+ *
+ * Entries that are not retained (the current and queued tracks) expire once
+ * unused for EntryTtlMs, and the least recently used ones are evicted when
+ * the registry grows past MaxEntries.
+ */
+class MediaRegistry
+{
+public:
+    static constexpr qsizetype MaxEntries = 1024;
+    static constexpr qint64 EntryTtlMs = 6 * 60 * 60 * 1000;
+
+    struct Stats
+    {
+        qsizetype entries{0};
+        qsizetype retained{0};
+        qint64 pathBytes{0}; // Memory used by the stored paths
+        quint64 expired{0};  // Entries dropped by TTL or LRU since startup
+    };
+
+    // Who keeps entries from expiring; each replaces only its own files
+    enum class Holder : quint8
+    {
+        Playback, // The current track and what is served for it
+        Upcoming  // Queued tracks and their pre-transcoded outputs
+    };
+
+    MediaRegistry();
+
+    // Register filePath and return its URL path
+    QString addMedia(const QString& filePath);
+    QString addCover(const QString& mediaPath);
+
+    // Return an empty string if urlPath is not registered
+    [[nodiscard]] QString mediaPath(const QString& urlPath) const;
+    [[nodiscard]] QString coverPath(const QString& urlPath) const;
+
+    // Entries for these files never expire; replaces the holder's previous set
+    void retain(Holder holder, const QStringList& filePaths);
+
+    void clear();
+    [[nodiscard]] Stats stats() const;
+
+private:
+    enum Kind : quint8
+    {
+        Media = 0x1,
+        Cover = 0x2
+    };
+
+    struct Entry
+    {
+        QString path;
+        quint8 kinds{0};
+        mutable std::atomic<qint64> lastUsed{0}; // m_clock msecs, bumped under the shared lock
+    };
+
+    static quint64 fileId(const QString& filePath);
+    static bool parseUrl(QStringView urlPath, QStringView prefix, quint64& id, QStringView& suffix);
+
+    void add(const QString& filePath, Kind kind);
+    QString lookup(const QString& urlPath, Kind kind) const;
+    void expire();
+
+    mutable QReadWriteLock m_lock;
+    QElapsedTimer m_clock;
+    std::unordered_map<quint64, Entry> m_entries;
+    std::array<QSet<quint64>, 2> m_held; // By Holder
+    QSet<quint64> m_retained;            // Union of m_held
+    qint64 m_lastExpiry{0};
+    quint64 m_expired{0};
+};
+
+} // namespace Chromecast
@@ -0,0 +1,212 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "pcmliveencoder.h"
+
+#include "livestream.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Receivers only need stereo; further channels are dropped
+constexpr int MaxChannels = 2;
+
+int inputSampleBytes(Fooyin::SampleFormat format)
+{
+    switch (format) {
+        case Fooyin::SampleFormat::U8:
+            return 1;
+        case Fooyin::SampleFormat::S16:
+            return 2;
+        case Fooyin::SampleFormat::S24In32:
+        case Fooyin::SampleFormat::S32:
+        case Fooyin::SampleFormat::F32:
+            return 4;
+        case Fooyin::SampleFormat::F64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+// Sample scaled to the full 32-bit range
+int32_t readSample(const char* data, Fooyin::SampleFormat format)
+{
+    switch (format) {
+        case Fooyin::SampleFormat::U8:
+            return (static_cast<int32_t>(static_cast<uint8_t>(*data)) - 128) * (1 << 24);
+        case Fooyin::SampleFormat::S16: {
+            int16_t sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            return static_cast<int32_t>(sample) * (1 << 16);
+        }
+        case Fooyin::SampleFormat::S24In32: {
+            int32_t sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            return static_cast<int32_t>(static_cast<uint32_t>(sample) << 8);
+        }
+        case Fooyin::SampleFormat::S32: {
+            int32_t sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            return sample;
+        }
+        case Fooyin::SampleFormat::F32: {
+            float sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            return static_cast<int32_t>(std::clamp(static_cast<double>(sample) * 2147483648.0, -2147483648.0,
+                                                   2147483647.0));
+        }
+        case Fooyin::SampleFormat::F64: {
+            double sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            return static_cast<int32_t>(std::clamp(sample * 2147483648.0, -2147483648.0, 2147483647.0));
+        }
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+namespace Chromecast {
+
+PcmLiveEncoder::PcmLiveEncoder(std::shared_ptr<LiveStream> stream, const Fooyin::AudioFormat& input,
+                               int bitsPerSample)
+    : m_stream(std::move(stream))
+    , m_inputFormat(input.sampleFormat())
+    , m_inputBytes(inputSampleBytes(input.sampleFormat()))
+    , m_inputChannels(input.channelCount())
+    , m_channels(std::min(input.channelCount(), MaxChannels))
+    , m_outputBytes(bitsPerSample == 24 ? 3 : 2)
+    , m_dither(m_outputBytes == 2 && m_inputFormat != Fooyin::SampleFormat::U8
+               && m_inputFormat != Fooyin::SampleFormat::S16)
+{
+    m_stream->setHeader(wavHeader(input.sampleRate(), m_channels, m_outputBytes * 8));
+
+    qInfo() << "Live streaming" << input.sampleRate() << "Hz," << m_inputChannels << "channels as" << m_outputBytes * 8
+            << "bit WAV" << (m_dither ? "with dither" : "");
+}
+
+bool PcmLiveEncoder::isInputSupported(const Fooyin::AudioFormat& input)
+{
+    return inputSampleBytes(input.sampleFormat()) > 0 && input.sampleRate() > 0 && input.channelCount() > 0;
+}
+
+QByteArray PcmLiveEncoder::wavHeader(int sampleRate, int channels, int bitsPerSample)
+{
+    const int blockAlign = channels * bitsPerSample / 8;
+
+    QByteArray header(44, Qt::Uninitialized);
+    char* out = header.data();
+
+    // The length isn't known, so both sizes are left at their maximum,
+    // which receivers treat as "until the connection closes"
+    std::memcpy(out, "RIFF", 4);
+    qToLittleEndian<quint32>(0xFFFFFFFF, out + 4);
+    std::memcpy(out + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, out + 16);
+    qToLittleEndian<quint16>(1, out + 20); // WAVE_FORMAT_PCM
+    qToLittleEndian<quint16>(channels, out + 22);
+    qToLittleEndian<quint32>(sampleRate, out + 24);
+    qToLittleEndian<quint32>(sampleRate * blockAlign, out + 28);
+    qToLittleEndian<quint16>(blockAlign, out + 32);
+    qToLittleEndian<quint16>(bitsPerSample, out + 34);
+    std::memcpy(out + 36, "data", 4);
+    qToLittleEndian<quint32>(0xFFFFFFFF, out + 40);
+
+    return header;
+}
+
+bool PcmLiveEncoder::write(const char* data, int frames)
+{
+    if (m_finished || frames <= 0) {
+        return false;
+    }
+
+    const qsizetype outputSize = static_cast<qsizetype>(frames) * m_channels * m_outputBytes;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    if (m_inputFormat == Fooyin::SampleFormat::S16 && m_outputBytes == 2 && m_channels == m_inputChannels) {
+        // Already what the receiver wants
+        m_stream->append(QByteArray(data, outputSize));
+        return true;
+    }
+#endif
+
+    QByteArray packet(outputSize, Qt::Uninitialized);
+    char* out = packet.data();
+
+    const int inputFrameBytes = m_inputChannels * m_inputBytes;
+    for (int frame = 0; frame < frames; ++frame) {
+        const char* in = data + static_cast<qsizetype>(frame) * inputFrameBytes;
+        for (int channel = 0; channel < m_channels; ++channel) {
+            const int32_t sample = readSample(in + channel * m_inputBytes, m_inputFormat);
+            if (m_outputBytes == 3) {
+                // Rounded to nearest like the 16-bit path, without dither
+                const int64_t rounded = std::clamp<int64_t>(int64_t{sample} + (int64_t{1} << 7), INT32_MIN, INT32_MAX);
+                const uint32_t value  = static_cast<uint32_t>(static_cast<int32_t>(rounded)) >> 8;
+                out[0] = static_cast<char>(value & 0xFF);
+                out[1] = static_cast<char>((value >> 8) & 0xFF);
+                out[2] = static_cast<char>((value >> 16) & 0xFF);
+                out += 3;
+            } else {
+                int64_t value = sample;
+                if (m_dither) {
+                    value += ditherNoise();
+                }
+                // Half an LSB so the shift rounds to nearest instead of truncating
+                value += int64_t{1} << 15;
+                value = std::clamp<int64_t>(value, INT32_MIN, INT32_MAX);
+                qToLittleEndian<qint16>(static_cast<qint16>(value >> 16), out);
+                out += 2;
+            }
+        }
+    }
+
+    m_stream->append(packet);
+    return true;
+}
+
+void PcmLiveEncoder::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_stream->finish();
+}
+
+int32_t PcmLiveEncoder::ditherNoise()
+{
+    // Triangular noise of +-1 LSB at 16 bits from two uniform values
+    // (xorshift32, as this runs for every sample)
+    const auto next = [this]() {
+        m_noiseState ^= m_noiseState << 13;
+        m_noiseState ^= m_noiseState >> 17;
+        m_noiseState ^= m_noiseState << 5;
+        return static_cast<int32_t>(m_noiseState & 0xFFFF);
+    };
+    return next() + next() - 0xFFFF;
+}
+
+} // namespace Chromecast
@@ -0,0 +1,64 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "liveencoder.h"
+
+#include <core/engine/audioformat.h>
+
+#include <QByteArray>
+
+#include <cstdint>
+
+namespace Chromecast {
+
+/*!
+ * LiveEncoder that wraps the PCM in a WAV container without encoding it.
+ *
+ * Samples are converted to the 16- or 24-bit little-endian integers that
+ * receivers accept (16-bit output from higher resolution input is dithered)
+ * and at most two channels are kept. The sample rate is passed through.
+ * For 16-bit input this is a plain copy.
+ */
+class PcmLiveEncoder : public LiveEncoder
+{
+public:
+    PcmLiveEncoder(std::shared_ptr<LiveStream> stream, const Fooyin::AudioFormat& input, int bitsPerSample);
+
+    static bool isInputSupported(const Fooyin::AudioFormat& input);
+    static QByteArray wavHeader(int sampleRate, int channels, int bitsPerSample);
+
+    bool write(const char* data, int frames) override;
+    void finish() override;
+
+private:
+    int32_t ditherNoise();
+
+    std::shared_ptr<LiveStream> m_stream;
+    Fooyin::SampleFormat m_inputFormat;
+    int m_inputBytes;         // Per sample
+    int m_inputChannels;
+    int m_channels;
+    int m_outputBytes;
+    bool m_dither;
+    uint32_t m_noiseState{0x12345678};
+    bool m_finished{false};
+};
+
+} // namespace Chromecast
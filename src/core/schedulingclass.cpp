@@ -0,0 +1,116 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "schedulingclass.h"
+
+#include <QDir>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+// From linux/ioprio.h, which not every distribution installs
+constexpr int IoprioWhoProcess      = 1;
+constexpr int IoprioClassShift      = 13;
+constexpr int IoprioClassBestEffort = 2;
+constexpr int IoprioClassIdle       = 3;
+constexpr int IoprioNormalLevel     = 4;
+#endif
+
+// id is a thread on Linux and a process elsewhere; 0 for the caller
+bool apply(qint64 id, const Chromecast::SchedulingClass& scheduling)
+{
+#ifdef Q_OS_UNIX
+    bool applied = setpriority(PRIO_PROCESS, static_cast<id_t>(id), std::clamp(scheduling.niceness, 0, 19)) == 0;
+#ifdef Q_OS_LINUX
+    const int ioprio = scheduling.idleIo ? IoprioClassIdle << IoprioClassShift
+                                         : (IoprioClassBestEffort << IoprioClassShift) | IoprioNormalLevel;
+    applied = syscall(SYS_ioprio_set, IoprioWhoProcess, static_cast<int>(id), ioprio) == 0 && applied;
+#endif
+    return applied;
+#else
+    Q_UNUSED(id)
+    Q_UNUSED(scheduling)
+    return false;
+#endif
+}
+} // namespace
+
+namespace Chromecast {
+
+bool SchedulingClass::applyToCurrentProcess() const
+{
+    return apply(0, *this);
+}
+
+bool SchedulingClass::applyToProcess(qint64 pid) const
+{
+    if (pid <= 0) {
+        return false;
+    }
+#ifdef Q_OS_LINUX
+    // Nice values are per thread; threads started later inherit the main one's
+    bool applied{true};
+    const QStringList threads = QDir(QString("/proc/%1/task").arg(pid)).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& thread : threads) {
+        applied = apply(thread.toLongLong(), *this) && applied;
+    }
+    return applied && !threads.isEmpty();
+#else
+    return apply(pid, *this);
+#endif
+}
+
+bool SchedulingClass::applyToCurrentThread() const
+{
+#ifdef Q_OS_LINUX
+    return apply(currentThreadId(), *this);
+#else
+    // Would change the whole player
+    return false;
+#endif
+}
+
+bool SchedulingClass::applyToThread(qint64 threadId) const
+{
+#ifdef Q_OS_LINUX
+    return threadId > 0 && apply(threadId, *this);
+#else
+    Q_UNUSED(threadId)
+    return false;
+#endif
+}
+
+qint64 SchedulingClass::currentThreadId()
+{
+#ifdef Q_OS_LINUX
+    return static_cast<qint64>(syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+}
+
+} // namespace Chromecast
@@ -0,0 +1,62 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QtGlobal>
+
+namespace Chromecast {
+
+/*!
+ * CPU and disk priority for transcoding work, so encodes of later tracks
+ * only use what the player and the desktop leave idle.
+ *
+ * On Linux this sets the nice value and I/O scheduling class per thread;
+ * other Unix systems only get the nice value of whole processes, and
+ * elsewhere nothing is changed. Lowering a priority always works; raising
+ * it again may need privileges the player doesn't have, in which case the
+ * apply functions return false and leave it as it is.
+ */
+struct SchedulingClass
+{
+    int niceness{0};    // 0 (normal) to 19 (only when nothing else runs)
+    bool idleIo{false}; // Disk access only when no one else is waiting for it
+    int threads{0};     // Threads a job may use, 0 for no limit
+
+    bool operator==(const SchedulingClass& other) const = default;
+
+    // Whether this gets less CPU or disk time than other in some respect
+    [[nodiscard]] bool isBelow(const SchedulingClass& other) const
+    {
+        return niceness > other.niceness || (idleIo && !other.idleIo);
+    }
+
+    // For the calling process between fork() and exec(); async-signal-safe
+    bool applyToCurrentProcess() const;
+    // Every thread of a running process
+    bool applyToProcess(qint64 pid) const;
+    // The calling thread, inherited by the threads it starts later
+    bool applyToCurrentThread() const;
+    // One thread by its kernel thread ID
+    bool applyToThread(qint64 threadId) const;
+
+    // Kernel ID of the calling thread, 0 where threads can't be told apart
+    static qint64 currentThreadId();
+};
+
+} // namespace Chromecast
@@ -0,0 +1,227 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "transcodecache.h"
+
+#include "transcodingmanager.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// Bump when the encoder arguments change, so stale outputs miss
+constexpr int CacheVersion = 1;
+
+const QString PartSuffix = QStringLiteral(".part");
+const QString SeekInfix  = QStringLiteral(".seek");
+} // namespace
+
+namespace Chromecast {
+
+TranscodeCache::TranscodeCache(const QString& directory, qint64 maxBytes)
+    : m_directory(directory)
+    , m_maxBytes(maxBytes)
+{
+    load();
+}
+
+QString TranscodeCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/chromecast-transcodes";
+}
+
+void TranscodeCache::setMaxBytes(qint64 maxBytes)
+{
+    m_maxBytes = std::max<qint64>(0, maxBytes);
+    evict({});
+}
+
+QString TranscodeCache::find(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                            const QString& variant)
+{
+    const QString path = outputPath(sourcePath, format, quality, variant);
+    const auto it = m_entries.find(QFileInfo(path).fileName());
+    if (it == m_entries.end() || !QFile::exists(path)) {
+        ++m_misses;
+        return {};
+    }
+
+    ++m_hits;
+
+    // Persist the use so LRU order survives restarts
+    it->lastUsed = QDateTime::currentDateTimeUtc();
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+        file.setFileTime(it->lastUsed, QFileDevice::FileAccessTime);
+    }
+
+    return path;
+}
+
+bool TranscodeCache::contains(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                              const QString& variant) const
+{
+    const QString path = outputPath(sourcePath, format, quality, variant);
+    return m_entries.contains(QFileInfo(path).fileName()) && QFile::exists(path);
+}
+
+QString TranscodeCache::outputPath(const QString& sourcePath, TranscodingFormat format,
+                                   TranscodingQuality quality, const QString& variant) const
+{
+    const QFileInfo source(sourcePath);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(CacheVersion));
+    hash.addData(source.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(source.size()));
+    hash.addData(QByteArray::number(source.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(static_cast<int>(format)));
+    hash.addData(QByteArray::number(static_cast<int>(quality)));
+    // Only when set, so outputs without one keep their names
+    if (!variant.isEmpty()) {
+        hash.addData(variant.toUtf8());
+    }
+
+    return QString("%1/%2.%3").arg(m_directory, QString::fromLatin1(hash.result().toHex()),
+                                   TranscodingManager::fileExtension(format));
+}
+
+QString TranscodeCache::partPath(const QString& outputPath)
+{
+    return outputPath + PartSuffix;
+}
+
+QString TranscodeCache::seekPath(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                                 double startOffset, const QString& variant) const
+{
+    // <hash>.seek<ms>.<ext>, keeping the extension the HTTP server types by
+    const QFileInfo output(outputPath(sourcePath, format, quality, variant));
+    return QString("%1/%2%3%4.%5")
+        .arg(m_directory, output.completeBaseName(), SeekInfix)
+        .arg(std::llround(startOffset * 1000.0))
+        .arg(output.suffix());
+}
+
+bool TranscodeCache::commit(const QString& outputPath)
+{
+    const QString part = partPath(outputPath);
+
+    // rename() won't replace an existing file
+    QFile::remove(outputPath);
+    if (!QFile::rename(part, outputPath)) {
+        qWarning() << "Transcode cache: Failed to move" << part << "into place";
+        QFile::remove(part);
+        return false;
+    }
+
+    const QFileInfo info(outputPath);
+    const QString name = info.fileName();
+    if (const auto it = m_entries.constFind(name); it != m_entries.cend()) {
+        m_usedBytes -= it->size;
+    }
+    m_entries.insert(name, {info.size(), QDateTime::currentDateTimeUtc()});
+    m_usedBytes += info.size();
+
+    evict(name);
+    return true;
+}
+
+void TranscodeCache::clear()
+{
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        QFile::remove(m_directory + "/" + it.key());
+    }
+    m_entries.clear();
+    m_usedBytes = 0;
+}
+
+TranscodeCache::Stats TranscodeCache::stats() const
+{
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.files = static_cast<int>(m_entries.size());
+    stats.usedBytes = m_usedBytes;
+    stats.maxBytes = m_maxBytes;
+    return stats;
+}
+
+void TranscodeCache::load()
+{
+    QDir dir(m_directory);
+    if (!dir.mkpath(".")) {
+        qWarning() << "Transcode cache: Cannot create" << m_directory;
+        return;
+    }
+
+    const QFileInfoList files = dir.entryInfoList(QDir::Files);
+    for (const QFileInfo& info : files) {
+        // Left behind by a crash or an interrupted transcode
+        if (info.fileName().endsWith(PartSuffix) || info.completeBaseName().contains(SeekInfix)) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+
+        QDateTime lastUsed = info.lastRead();
+        if (!lastUsed.isValid()) {
+            lastUsed = info.lastModified();
+        }
+        m_entries.insert(info.fileName(), {info.size(), lastUsed});
+        m_usedBytes += info.size();
+    }
+
+    qInfo() << "Transcode cache:" << m_entries.size() << "files," << m_usedBytes / (1024 * 1024) << "MB in"
+            << m_directory;
+
+    evict({});
+}
+
+void TranscodeCache::evict(const QString& keep)
+{
+    if (m_usedBytes <= m_maxBytes) {
+        return;
+    }
+
+    std::vector<std::pair<QDateTime, QString>> candidates;
+    candidates.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (it.key() != keep) {
+            candidates.emplace_back(it->lastUsed, it.key());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& [lastUsed, name] : candidates) {
+        if (m_usedBytes <= m_maxBytes) {
+            break;
+        }
+        qDebug() << "Transcode cache: Evicting" << name;
+        QFile::remove(m_directory + "/" + name);
+        m_usedBytes -= m_entries.take(name).size;
+    }
+}
+
+} // namespace Chromecast
@@ -0,0 +1,106 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <chromecast/chromecast_common.h>
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+namespace Chromecast {
+
+/*!
+ * On-disk cache of transcoded tracks.
+ *
+ * Outputs are named by a hash of the source's path, size and modification
+ * time plus the target format, quality and variant, so a retagged or replaced file
+ * misses and same-named files in different albums never collide. Files are
+ * written under a ".part" name and renamed into place once complete, so a
+ * crash never leaves a truncated entry behind. When the cache grows past
+ * its limit the least recently used outputs are deleted.
+ *
+ * Outputs that start part way into a track (for seeks) are written to the
+ * same directory but are never entries; whoever serves them removes them,
+ * and any left behind are deleted at the next startup.
+ *
+ * Not thread-safe; used from the thread that owns the TranscodingManager.
+ */
+class TranscodeCache
+{
+public:
+    struct Stats
+    {
+        quint64 hits{0};
+        quint64 misses{0};
+        int files{0};
+        qint64 usedBytes{0};
+        qint64 maxBytes{0};
+    };
+
+    static constexpr qint64 DefaultMaxBytes = 2LL * 1024 * 1024 * 1024;
+
+    explicit TranscodeCache(const QString& directory, qint64 maxBytes = DefaultMaxBytes);
+
+    static QString defaultDirectory();
+
+    void setMaxBytes(qint64 maxBytes);
+
+    // variant tells apart outputs of one format and quality that differ in
+    // other ways, e.g. sample rate; empty for none
+
+    // Path of the complete output, empty (and counted as a miss) if not cached
+    QString find(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                 const QString& variant = {});
+    [[nodiscard]] bool contains(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                                const QString& variant = {}) const;
+    // Where the output for this source belongs once complete
+    [[nodiscard]] QString outputPath(const QString& sourcePath, TranscodingFormat format,
+                                     TranscodingQuality quality, const QString& variant = {}) const;
+    // Temporary name to write outputPath under until it is complete
+    static QString partPath(const QString& outputPath);
+    // Where to write output starting startOffset seconds into the source
+    [[nodiscard]] QString seekPath(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                                   double startOffset, const QString& variant = {}) const;
+
+    // Move a finished partPath() into place, then evict down to the limit
+    bool commit(const QString& outputPath);
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Entry
+    {
+        qint64 size{0};
+        QDateTime lastUsed;
+    };
+
+    void load();
+    void evict(const QString& keep);
+
+    QString m_directory;
+    qint64 m_maxBytes;
+    QHash<QString, Entry> m_entries; // File name -> entry
+    qint64 m_usedBytes{0};
+    quint64 m_hits{0};
+    quint64 m_misses{0};
+};
+
+} // namespace Chromecast
@@ -16,148 +16,1169 @@
  * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #include "transcodingmanager.h"
 
+#ifdef CHROMECAST_HAVE_LIBAV
+#include "libavtranscoder.h"
+#endif
+
 #include <QFileInfo>
 #include <QProcess>
+#include <QRegularExpression>
+#include <QThread>
 #include <QDebug>
 
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Minimum time between jobProgress signals of one job
+constexpr qint64 ProgressInterval = 250;
+// ffmpeg log lines kept for the failure report
+constexpr int ErrorTailLines = 8;
+// How long the measured link must stay below the bitrate limit before
+// the limit follows it down, so one stall doesn't change the output
+constexpr qint64 LimitLowerHoldMs = 10000;
+// The limit follows a faster link at this share of its rate, so the output
+// only steps up once the link clears the next step by a margin
+constexpr int LimitRaisePercent = 80;
+
+// Complete lines of buffer, leaving a trailing partial line in it
+QList<QByteArray> takeLines(QByteArray& buffer)
+{
+    QList<QByteArray> lines;
+    qsizetype start{0};
+    qsizetype end{0};
+    while ((end = buffer.indexOf('\n', start)) >= 0) {
+        const QByteArray line = buffer.mid(start, end - start).trimmed();
+        if (!line.isEmpty()) {
+            lines.append(line);
+        }
+        start = end + 1;
+    }
+    buffer.remove(0, start);
+    return lines;
+}
+
+// Highest rate up to maxRate in the source's family of 44.1 or 48 kHz
+// multiples, so 88.2 kHz goes to 44.1 kHz rather than 48 kHz
+int reducedSampleRate(int sourceRate, int maxRate)
+{
+    int rate = sourceRate % 11025 == 0 ? 44100 : 48000;
+    while (rate * 2 <= maxRate) {
+        rate *= 2;
+    }
+    return rate <= maxRate ? rate : maxRate;
+}
+} // namespace
+
 namespace Chromecast {
 
+int TranscodingManager::Progress::percent() const
+{
+    if (duration <= 0.0) {
+        return -1;
+    }
+    return std::clamp(static_cast<int>(position * 100.0 / duration), 0, 100);
+}
+
+double TranscodingManager::Progress::remaining() const
+{
+    if (duration <= 0.0 || speed <= 0.0) {
+        return -1.0;
+    }
+    return std::max(0.0, duration - position) / speed;
+}
+
+bool TranscodingManager::Progress::staysAheadOfPlayback() const
+{
+    if (speed >= 1.0) {
+        return true;
+    }
+    const double left = remaining();
+    if (left < 0.0) {
+        return false;
+    }
+    // Playback gains 1 - speed seconds on the encode every second
+    return position / (1.0 - speed) >= left;
+}
+
 TranscodingManager::TranscodingManager(QObject* parent)
     : QObject(parent)
-    , m_transcodeProcess(new QProcess(this))
+    , m_cache(TranscodeCache::defaultDirectory())
+    , m_maxConcurrentJobs(defaultMaxConcurrentJobs())
 {
-    connect(m_transcodeProcess, &QProcess::finished, this, &TranscodingManager::onProcessFinished);
-    connect(m_transcodeProcess, &QProcess::errorOccurred, this, &TranscodingManager::onProcessError);
-    connect(m_transcodeProcess, &QProcess::readyReadStandardOutput, this, &TranscodingManager::onProcessOutput);
-    connect(m_transcodeProcess, &QProcess::readyReadStandardError, this, &TranscodingManager::onProcessOutput);
+    setBackend(defaultBackend());
+    // Bound by the disk more than the CPU
+    m_probePool.setMaxThreadCount(2);
+    for (const Priority priority : {Priority::Background, Priority::Normal, Priority::Playback}) {
+        m_scheduling[static_cast<size_t>(priority)] = defaultSchedulingClass(priority);
+    }
 }
 
 TranscodingManager::~TranscodingManager()
 {
-    if (m_transcodeProcess->state() == QProcess::Running) {
-        m_transcodeProcess->kill();
-        m_transcodeProcess->waitForFinished(3000);
+    m_probePool.clear();
+    m_probePool.waitForDone();
+
+    for (const auto& job : m_jobs) {
+        if (job->process && job->process->state() != QProcess::NotRunning) {
+            job->process->disconnect(this);
+            job->process->kill();
+            job->process->waitForFinished(3000);
+        }
+        if (job->thread) {
+            job->thread->disconnect(this);
+            job->run->cancelled = true;
+            job->thread->wait();
+            delete job->thread;
+        }
     }
 }
 
 bool TranscodingManager::isFormatSupported(const QString& filePath) const
 {
-    QFileInfo fileInfo(filePath);
-    QString extension = fileInfo.suffix().toLower();
+    const MediaInfo info = m_probe.probe(filePath);
+    if (!info.isValid()) {
+        // Unreadable here; let the extension decide and the receiver report
+        static const QStringList NativeExtensions = {"mp3", "aac", "m4a", "opus", "flac", "ogg", "wav"};
+        return NativeExtensions.contains(QFileInfo(filePath).suffix().toLower());
+    }
 
-    // Chromecast natively supports:
-    // AAC, MP3, Opus, FLAC, Vorbis, WAV
-    QStringList supportedExtensions = {"aac", "mp3", "opus", "flac", "ogg", "wav"};
+    if (const QString reason = m_capabilities.unsupportedReason(info); !reason.isEmpty()) {
+        qDebug() << "Not playable as is:" << filePath << "-" << reason;
+        return false;
+    }
+    return true;
+}
 
-    return supportedExtensions.contains(extension);
+bool TranscodingManager::needsTranscoding(const QString& filePath) const
+{
+    if (!isFormatSupported(filePath)) {
+        return true;
+    }
+
+    // Playable, but too much for the link
+    const MediaInfo info = m_probe.probe(filePath);
+    if (m_bitrateLimit > 0 && info.isLossless()) {
+        const int kbps = info.bitrate > 0 ? info.bitrate
+                                          : estimatedBitrate(info.codec == u"flac" ? TranscodingFormat::FLAC
+                                                                                   : TranscodingFormat::WAV,
+                                                             TranscodingQuality::High);
+        return kbps > m_bitrateLimit;
+    }
+    return false;
 }
 
-bool TranscodingManager::transcodeFile(const QString& sourcePath, const QString& destPath,
-                                      TranscodingFormat format, TranscodingQuality quality)
+MediaInfo TranscodingManager::mediaInfo(const QString& filePath) const
+{
+    return m_probe.probe(filePath);
+}
+
+bool TranscodingManager::isProbed(const QString& filePath) const
+{
+    return m_probe.isCached(filePath);
+}
+
+void TranscodingManager::probeInBackground(const QStringList& filePaths)
+{
+    for (const QString& path : filePaths) {
+        if (m_probing.contains(path) || m_probe.isCached(path)) {
+            continue;
+        }
+        m_probing.insert(path);
+        // The destructor waits for the pool, so this outlives the task
+        m_probePool.start([this, path]() {
+            m_probe.probe(path);
+            QMetaObject::invokeMethod(
+                this,
+                [this, path]() {
+                    m_probing.remove(path);
+                    emit mediaProbed(path);
+                },
+                Qt::QueuedConnection);
+        });
+    }
+}
+
+void TranscodingManager::setDeviceCapabilities(const DeviceCapabilities& capabilities)
+{
+    qInfo() << "Receiver" << capabilities.model << "plays up to" << capabilities.maxSampleRate << "Hz,"
+            << capabilities.maxBitDepth << "bit," << capabilities.maxChannels << "channels natively";
+
+    m_capabilities = capabilities;
+    emit deviceCapabilitiesChanged();
+}
+
+const DeviceCapabilities& TranscodingManager::deviceCapabilities() const
+{
+    return m_capabilities;
+}
+
+void TranscodingManager::setOutputFormat(TranscodingFormat format, TranscodingQuality quality)
+{
+    m_preferredFormat = format;
+    m_preferredQuality = quality;
+    updateOutputFormat();
+}
+
+void TranscodingManager::setBitrateLimit(int kbps)
+{
+    kbps = std::max(0, kbps);
+
+    if (kbps == 0) {
+        // Not measured or turned off: no limit right away
+        m_limitLowSince.invalidate();
+        m_bitrateLimit = 0;
+    } else if (m_bitrateLimit == 0 || kbps < m_bitrateLimit) {
+        if (!m_limitLowSince.isValid()) {
+            m_limitLowSince.start();
+            return;
+        }
+        if (m_limitLowSince.elapsed() < LimitLowerHoldMs) {
+            return;
+        }
+        m_limitLowSince.invalidate();
+        m_bitrateLimit = kbps;
+    } else {
+        m_limitLowSince.invalidate();
+        const auto raised = static_cast<int>(static_cast<qint64>(kbps) * LimitRaisePercent / 100);
+        m_bitrateLimit    = std::max(m_bitrateLimit, raised);
+    }
+
+    updateOutputFormat();
+}
+
+int TranscodingManager::bitrateLimit() const
+{
+    return m_bitrateLimit;
+}
+
+void TranscodingManager::updateOutputFormat()
+{
+    TranscodingFormat format = m_preferredFormat;
+    TranscodingQuality quality = m_preferredQuality;
+
+    if (m_bitrateLimit > 0 && estimatedBitrate(format, quality) > m_bitrateLimit) {
+        // Lossless formats have no cheaper setting, so switch to a lossy one
+        if (format == TranscodingFormat::FLAC || format == TranscodingFormat::WAV) {
+            format = TranscodingFormat::AAC;
+            quality = TranscodingQuality::High;
+        }
+        while (estimatedBitrate(format, quality) > m_bitrateLimit && quality != TranscodingQuality::Efficient) {
+            quality = static_cast<TranscodingQuality>(static_cast<int>(quality) + 1);
+        }
+    }
+
+    if (format == m_outputFormat && quality == m_outputQuality) {
+        return;
+    }
+
+    m_outputFormat = format;
+    m_outputQuality = quality;
+    qInfo() << "Transcoding to" << formatName(format) << qualityName(quality) << "(limit" << m_bitrateLimit
+            << "kbit/s)";
+    emit outputFormatChanged();
+}
+
+TranscodingFormat TranscodingManager::outputFormat() const
+{
+    return m_outputFormat;
+}
+
+TranscodingQuality TranscodingManager::outputQuality() const
+{
+    return m_outputQuality;
+}
+
+TranscodingFormat TranscodingManager::outputFormatFor(const QString& sourcePath) const
+{
+    if (!m_keepLossless || m_outputFormat == TranscodingFormat::FLAC || m_outputFormat == TranscodingFormat::WAV
+        || !m_capabilities.codecs.contains(QStringLiteral("flac"))) {
+        return m_outputFormat;
+    }
+
+    const MediaInfo info = m_probe.probe(sourcePath);
+    if (!info.isValid() || !info.isLossless()) {
+        return m_outputFormat;
+    }
+
+    // FLAC at what the receiver takes, if the link carries it. FLAC packs
+    // music to about 60% of PCM.
+    const Downconversion conversion = downconversion(sourcePath, TranscodingFormat::FLAC);
+    const qint64 sampleRate = conversion.sampleRate > 0 ? conversion.sampleRate : info.sampleRate;
+    const qint64 bitDepth   = conversion.bitDepth > 0 ? conversion.bitDepth : std::max(info.bitDepth, 16);
+    const qint64 channels   = conversion.channels > 0 ? conversion.channels : std::max(info.channels, 1);
+    const auto kbps         = static_cast<int>(sampleRate * bitDepth * channels * 6 / 10000);
+    if (m_bitrateLimit > 0 && kbps > m_bitrateLimit) {
+        return m_outputFormat;
+    }
+    return TranscodingFormat::FLAC;
+}
+
+void TranscodingManager::setKeepLossless(bool enabled)
+{
+    if (enabled == m_keepLossless) {
+        return;
+    }
+    m_keepLossless = enabled;
+    emit outputFormatChanged();
+}
+
+bool TranscodingManager::keepLossless() const
+{
+    return m_keepLossless;
+}
+
+TranscodingManager::Downconversion TranscodingManager::downconversion(const QString& sourcePath,
+                                                                     TranscodingFormat format) const
+{
+    Downconversion conversion;
+
+    const MediaInfo info = m_probe.probe(sourcePath);
+    if (!info.isValid()) {
+        return conversion;
+    }
+
+    // Opus always encodes at 48 kHz
+    if (format != TranscodingFormat::Opus && info.sampleRate > m_capabilities.maxSampleRate) {
+        conversion.sampleRate = reducedSampleRate(info.sampleRate, m_capabilities.maxSampleRate);
+    }
+    // Lossy formats have no bit depth, and the WAV encoder is 16-bit only
+    if (format == TranscodingFormat::FLAC && info.bitDepth > m_capabilities.maxBitDepth) {
+        conversion.bitDepth = m_capabilities.maxBitDepth;
+    } else if (format == TranscodingFormat::WAV && info.bitDepth > 16) {
+        conversion.bitDepth = 16;
+    }
+    if (info.channels > m_capabilities.maxChannels) {
+        conversion.channels = m_capabilities.maxChannels;
+    }
+    return conversion;
+}
+
+QString TranscodingManager::Downconversion::variant() const
+{
+    if (*this == Downconversion{}) {
+        return {};
+    }
+    return QString("%1hz-%2bit-%3ch").arg(sampleRate).arg(bitDepth).arg(channels);
+}
+
+TranscodingManager::JobId TranscodingManager::transcode(const QString& sourcePath, const QString& destPath,
+                                                        TranscodingFormat format, TranscodingQuality quality,
+                                                        Priority priority)
+{
+    return addJob(sourcePath, destPath, false, format, quality, priority);
+}
+
+TranscodingManager::JobId TranscodingManager::transcode(const QString& sourcePath, TranscodingFormat format,
+                                                        TranscodingQuality quality, Priority priority)
+{
+    const QString variant = downconversion(sourcePath, format).variant();
+    return addJob(sourcePath, m_cache.outputPath(sourcePath, format, quality, variant), true, format, quality,
+                  priority);
+}
+
+TranscodingManager::JobId TranscodingManager::transcodeFrom(const QString& sourcePath, double startOffset,
+                                                            TranscodingFormat format, TranscodingQuality quality,
+                                                            Priority priority)
+{
+    if (startOffset <= 0.0) {
+        // The caller removes the output, which mustn't be the cached one
+        qWarning() << "Not transcoding" << sourcePath << "from" << startOffset << "s: use the full transcode";
+        return 0;
+    }
+    const QString variant = downconversion(sourcePath, format).variant();
+    return addJob(sourcePath, m_cache.seekPath(sourcePath, format, quality, startOffset, variant), false, format,
+                  quality, priority, startOffset);
+}
+
+TranscodingManager::JobId TranscodingManager::addJob(const QString& sourcePath, const QString& destPath, bool cached,
+                                                     TranscodingFormat format, TranscodingQuality quality,
+                                                     Priority priority, double startOffset)
 {
     if (!QFile::exists(sourcePath)) {
         qWarning() << "Source file does not exist:" << sourcePath;
         emit transcodingError(sourcePath, "Source file does not exist");
-        return false;
+        return 0;
+    }
+
+    const Downconversion conversion = downconversion(sourcePath, format);
+
+    // Same source and settings as an unfinished job: share its output
+    const auto existing = std::find_if(m_jobs.cbegin(), m_jobs.cend(), [&](const auto& job) {
+        return !job->cancelled && job->sourcePath == sourcePath && job->format == format && job->quality == quality
+            && job->startOffset == startOffset && job->conversion == conversion;
+    });
+    if (existing != m_jobs.cend()) {
+        Job& job = **existing;
+        ++job.requests;
+        qInfo() << "Joining transcoding job" << job.id << "for" << sourcePath << "(" << job.requests << "requests)";
+
+        const JobId id = job.id;
+        if (priority > job.priority) {
+            job.priority = priority;
+            if (!job.started()) {
+                startQueuedJobs();
+            } else if (!applyScheduling(job) && job.scheduling.isBelow(schedulingClass(priority))) {
+                // Lowered priority usually can't be raised again without
+                // privileges. Unless the job is fast enough as it is, start
+                // over with a worker at the new one.
+                if (job.progress.staysAheadOfPlayback()) {
+                    qInfo() << "Transcoding job" << id << "keeps its priority, it is ahead of playback";
+                } else {
+                    qInfo() << "Restarting transcoding job" << id << "at" << priority << "priority";
+                    restartJob(job);
+                }
+            }
+        }
+        return id;
+    }
+
+    auto job = std::make_unique<Job>();
+    job->id = m_nextJobId++;
+    job->sourcePath = sourcePath;
+    job->destPath = destPath;
+    job->writePath = cached ? TranscodeCache::partPath(destPath) : destPath;
+    job->cached = cached;
+    job->format = format;
+    job->quality = quality;
+    job->priority = priority;
+    job->startOffset = startOffset;
+    job->conversion = conversion;
+
+    const JobId id = job->id;
+    m_jobs.push_back(std::move(job));
+
+    qInfo() << "Queued transcoding job" << id << ":" << sourcePath << "from" << startOffset << "s to" << destPath
+            << "priority" << priority;
+
+    // Started synchronously when a slot is free, so callers can serve the
+    // output right away
+    startQueuedJobs();
+
+    return id;
+}
+
+bool TranscodingManager::transcodeFile(const QString& sourcePath, const QString& destPath,
+                                      TranscodingFormat format, TranscodingQuality quality)
+{
+    return transcode(sourcePath, destPath, format, quality) != 0;
+}
+
+void TranscodingManager::cancel(JobId id)
+{
+    Job* job = findJob(id);
+    if (!job || job->cancelled) {
+        return;
+    }
+
+    if (--job->requests > 0) {
+        return;
+    }
+
+    qInfo() << "Cancelling transcoding job" << id << ":" << job->sourcePath;
+    job->cancelled = true;
+
+    if (job->process) {
+        // finishJob() runs from the finished signal
+        job->process->kill();
+    } else if (job->thread) {
+        // Checked between packets; finishJob() runs once the thread ends
+        job->run->cancelled = true;
+    } else {
+        finishJob(id, false);
+    }
+}
+
+void TranscodingManager::cancelAll()
+{
+    std::vector<JobId> ids;
+    ids.reserve(m_jobs.size());
+    for (const auto& job : m_jobs) {
+        ids.push_back(job->id);
+    }
+
+    for (const JobId id : ids) {
+        if (Job* job = findJob(id)) {
+            job->requests = 1;
+            cancel(id);
+        }
+    }
+}
+
+QString TranscodingManager::cachedOutput(const QString& sourcePath, TranscodingFormat format,
+                                         TranscodingQuality quality)
+{
+    return m_cache.find(sourcePath, format, quality, downconversion(sourcePath, format).variant());
+}
+
+bool TranscodingManager::isCached(const QString& sourcePath, TranscodingFormat format,
+                                  TranscodingQuality quality) const
+{
+    return m_cache.contains(sourcePath, format, quality, downconversion(sourcePath, format).variant());
+}
+
+QString TranscodingManager::cachePath(const QString& sourcePath, TranscodingFormat format,
+                                      TranscodingQuality quality) const
+{
+    return m_cache.outputPath(sourcePath, format, quality, downconversion(sourcePath, format).variant());
+}
+
+void TranscodingManager::setCacheSize(qint64 bytes)
+{
+    m_cache.setMaxBytes(bytes);
+}
+
+TranscodeCache::Stats TranscodingManager::cacheStats() const
+{
+    return m_cache.stats();
+}
+
+QString TranscodingManager::outputPath(JobId id) const
+{
+    const Job* job = findJob(id);
+    return job ? job->destPath : QString{};
+}
+
+bool TranscodingManager::isActive(JobId id) const
+{
+    const Job* job = findJob(id);
+    return job && !job->cancelled;
+}
+
+int TranscodingManager::queuedJobCount() const
+{
+    return static_cast<int>(std::count_if(m_jobs.cbegin(), m_jobs.cend(), [](const auto& job) {
+        return !job->started() && !job->cancelled;
+    }));
+}
+
+int TranscodingManager::runningJobCount() const
+{
+    return static_cast<int>(std::count_if(m_jobs.cbegin(), m_jobs.cend(), [](const auto& job) {
+        return job->started();
+    }));
+}
+
+TranscodingManager::Progress TranscodingManager::progress(JobId id) const
+{
+    const Job* job = findJob(id);
+    return job ? job->progress : Progress{};
+}
+
+TranscodingManager::Stats TranscodingManager::stats() const
+{
+    return m_stats;
+}
+
+void TranscodingManager::setBackend(Backend backend)
+{
+    if (!isBackendAvailable(backend)) {
+        qWarning() << "Transcoding backend" << backend << "is not available, using" << m_backend;
+        return;
+    }
+
+#ifdef CHROMECAST_HAVE_LIBAV
+    if (backend == Backend::Library && !m_libav) {
+        m_libav = std::make_shared<LibavTranscoder>();
+        qInfo() << "Using in-process transcoding with FFmpeg" << LibavTranscoder::version();
+    }
+#endif
+
+    m_backend = backend;
+}
+
+TranscodingManager::Backend TranscodingManager::backend() const
+{
+    return m_backend;
+}
+
+bool TranscodingManager::isBackendAvailable(Backend backend)
+{
+    switch (backend) {
+        case Backend::Process:
+            return true;
+        case Backend::Library:
+#ifdef CHROMECAST_HAVE_LIBAV
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+TranscodingManager::Backend TranscodingManager::defaultBackend()
+{
+    return isBackendAvailable(Backend::Library) ? Backend::Library : Backend::Process;
+}
+
+void TranscodingManager::setMaxConcurrentJobs(int count)
+{
+    m_maxConcurrentJobs = std::max(1, count);
+    startQueuedJobs();
+}
+
+int TranscodingManager::maxConcurrentJobs() const
+{
+    return m_maxConcurrentJobs;
+}
+
+int TranscodingManager::defaultMaxConcurrentJobs()
+{
+    return std::max(1, QThread::idealThreadCount());
+}
+
+void TranscodingManager::setSchedulingClass(Priority priority, const SchedulingClass& scheduling)
+{
+    SchedulingClass& current = m_scheduling[static_cast<size_t>(priority)];
+    if (scheduling == current) {
+        return;
+    }
+    current = scheduling;
+
+    for (const auto& job : m_jobs) {
+        if (job->priority == priority && job->started()) {
+            applyScheduling(*job);
+        }
+    }
+}
+
+SchedulingClass TranscodingManager::schedulingClass(Priority priority) const
+{
+    return m_scheduling[static_cast<size_t>(priority)];
+}
+
+SchedulingClass TranscodingManager::defaultSchedulingClass(Priority priority)
+{
+    switch (priority) {
+        case Priority::Playback:
+            return {};
+        case Priority::Normal:
+            return {5, false, 0};
+        case Priority::Background:
+        default:
+            // Idle capacity only, but all of it
+            return {19, true, 0};
     }
+}
 
-    if (isProcessRunning()) {
-        qWarning() << "Transcoding process already running";
-        emit transcodingError(sourcePath, "Transcoding process already running");
+bool TranscodingManager::applyScheduling(Job& job)
+{
+    const SchedulingClass scheduling = schedulingClass(job.priority);
+
+    bool applied{false};
+    if (job.process) {
+        applied = scheduling.applyToProcess(job.process->processId());
+    } else if (job.run) {
+        applied = job.run->setScheduling(scheduling);
+        job.scheduling = job.run->scheduling();
+    }
+    if (!applied) {
+        qDebug() << "Cannot change the scheduling of transcoding job" << job.id << "to nice" << scheduling.niceness;
         return false;
     }
+    job.scheduling = scheduling;
+    return true;
+}
+
+void TranscodingManager::LibraryRun::addCurrentThread()
+{
+    const QMutexLocker locker(&lock);
+    const qint64 threadId = SchedulingClass::currentThreadId();
+    if (threadId == 0 || !requested.applyToCurrentThread()) {
+        // Left as it is, e.g. where threads can't be told apart
+        return;
+    }
+    if (threadIds.empty()) {
+        current = requested;
+    }
+    threadIds.push_back(threadId);
+}
+
+void TranscodingManager::LibraryRun::removeCurrentThread()
+{
+    const QMutexLocker locker(&lock);
+    // Thread IDs are reused once a thread is gone
+    std::erase(threadIds, SchedulingClass::currentThreadId());
+}
+
+bool TranscodingManager::LibraryRun::setScheduling(const SchedulingClass& scheduling)
+{
+    const QMutexLocker locker(&lock);
+    requested = scheduling;
+
+    bool applied{true};
+    for (const qint64 threadId : threadIds) {
+        applied = scheduling.applyToThread(threadId) && applied;
+    }
+    if (applied) {
+        current = scheduling;
+    }
+    return applied;
+}
+
+SchedulingClass TranscodingManager::LibraryRun::scheduling() const
+{
+    const QMutexLocker locker(&lock);
+    return current;
+}
+
+void TranscodingManager::restartJob(Job& job)
+{
+    const JobId id = job.id;
+    const auto restart = [this, id, run = job.run]() {
+        // Once only, though a thread may end after the check below
+        Job* job = findJob(id);
+        if (!job || job->run != run) {
+            return;
+        }
+        if (job->process) {
+            job->process->deleteLater();
+            job->process = nullptr;
+        }
+        if (job->thread) {
+            job->thread->deleteLater();
+            job->thread = nullptr;
+        }
+        job->run.reset();
+        job->slots         = 1;
+        job->scheduling    = {};
+        job->lastReport    = -1;
+        job->reportedSpeed = 0.0;
+        job->output.clear();
+        job->errorOutput.clear();
+        job->errorTail.clear();
+
+        if (job->cancelled) {
+            finishJob(id, false);
+        } else {
+            startJob(*job);
+        }
+    };
+
+    // The partial output stays in place for readers until the new worker
+    // rewrites it
+    if (job.process) {
+        job.process->disconnect(this);
+        connect(job.process, &QProcess::finished, this, restart);
+        if (job.process->state() == QProcess::NotRunning) {
+            QMetaObject::invokeMethod(this, restart, Qt::QueuedConnection);
+        } else {
+            job.process->kill();
+        }
+    } else if (job.thread) {
+        job.thread->disconnect(this);
+        connect(job.thread, &QThread::finished, this, restart);
+        job.run->cancelled = true;
+        if (job.thread->isFinished()) {
+            QMetaObject::invokeMethod(this, restart, Qt::QueuedConnection);
+        }
+    }
+}
 
-    qInfo() << "Starting transcoding:" << sourcePath << "to" << destPath;
+void TranscodingManager::startQueuedJobs()
+{
+    // Looked up afresh each time: a job that fails to start is removed
+    while (Job* job = nextQueuedJob()) {
+        if (job->priority != Priority::Playback && usedSlots() >= m_maxConcurrentJobs) {
+            break;
+        }
+        startJob(*job);
+    }
+}
 
-    m_currentSourcePath = sourcePath;
-    m_currentDestPath = destPath;
+TranscodingManager::Job* TranscodingManager::findJob(JobId id) const
+{
+    const auto it = std::find_if(m_jobs.cbegin(), m_jobs.cend(), [id](const auto& job) { return job->id == id; });
+    return it != m_jobs.cend() ? it->get() : nullptr;
+}
+
+int TranscodingManager::usedSlots() const
+{
+    int used{0};
+    for (const auto& job : m_jobs) {
+        if (job->started()) {
+            used += job->slots;
+        }
+    }
+    return used;
+}
+
+TranscodingManager::Job* TranscodingManager::nextQueuedJob() const
+{
+    Job* next{nullptr};
+    for (const auto& job : m_jobs) {
+        if (job->started() || job->cancelled) {
+            continue;
+        }
+        // m_jobs is in submission order, so ties keep the oldest
+        if (!next || job->priority > next->priority) {
+            next = job.get();
+        }
+    }
+    return next;
+}
+
+void TranscodingManager::startJob(Job& job)
+{
+    // Start from an empty file, so the HTTP server can open the output as
+    // soon as playback is requested and never sees a previous run's data
+    QFile::remove(job.writePath);
+    QFile destFile(job.writePath);
+    if (!destFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot create transcoding output:" << job.writePath << destFile.errorString();
+        finishJob(job.id, false, "Cannot create transcoding output file");
+        return;
+    }
+    destFile.close();
+
+    job.progress            = {};
+    job.progress.sourcePath = job.sourcePath;
+    job.progress.priority   = job.priority;
+    job.timer.start();
+
+    if (m_backend == Backend::Library) {
+        startLibraryJob(job);
+    } else {
+        startProcessJob(job);
+    }
+}
+
+void TranscodingManager::startProcessJob(Job& job)
+{
+    const SchedulingClass scheduling = schedulingClass(job.priority);
+    const QStringList args = ffmpegArguments(job, scheduling.threads);
+    const JobId id = job.id;
+
+    qInfo() << "Starting transcoding job" << id << ": ffmpeg" << args.join(" ");
+
+    job.process = new QProcess(this);
+    connect(job.process, &QProcess::finished, this, [this, id](int exitCode, QProcess::ExitStatus exitStatus) {
+        onProcessFinished(id, exitCode, exitStatus);
+    });
+    connect(job.process, &QProcess::errorOccurred, this,
+            [this, id](QProcess::ProcessError error) { onProcessError(id, error); });
+    connect(job.process, &QProcess::readyReadStandardOutput, this, [this, id]() { onProcessOutput(id); });
+    connect(job.process, &QProcess::readyReadStandardError, this, [this, id]() { onProcessOutput(id); });
+#ifdef Q_OS_UNIX
+    // Set in the child before ffmpeg runs, so it never competes at full priority
+    job.process->setChildProcessModifier([scheduling]() { scheduling.applyToCurrentProcess(); });
+    job.scheduling = scheduling;
+#endif
+
+    emit transcodingStarted(job.sourcePath);
+    emit outputOpened(job.destPath, job.writePath);
+
+    // Last use of job: a failed start may remove it from inside start()
+    job.process->start("ffmpeg", args);
+}
+
+void TranscodingManager::startLibraryJob(Job& job)
+{
+#ifdef CHROMECAST_HAVE_LIBAV
+    LibavTranscoder::Request request;
+    request.sourcePath = job.sourcePath;
+    request.outputPath = job.writePath;
+    request.muxer      = muxerName(job.format);
+    request.encoder    = encoderName(job.format);
+    request.bitrate    = bitrate(job.format, job.quality) * 1000;
+    request.vbrQuality = vbrQuality(job.format, job.quality);
+    request.startTime  = job.startOffset;
+    request.sampleRate = job.conversion.sampleRate;
+    request.bitDepth   = job.conversion.bitDepth;
+    request.channels   = job.conversion.channels;
+    // Long tracks may spread over the part of the pool that is idle. The
+    // slots stay held until the job ends, or until the transcoder finds it
+    // needs fewer, so queued jobs don't start on top of the segments.
+    const SchedulingClass scheduling = schedulingClass(job.priority);
+    request.threads = std::max(1, m_maxConcurrentJobs - usedSlots());
+    if (scheduling.threads > 0) {
+        request.threads = std::min(request.threads, scheduling.threads);
+    }
+    job.slots = request.threads;
+
+    const JobId id = job.id;
+
+    qInfo() << "Starting transcoding job" << id << "in-process:" << request.encoder << "to" << job.writePath;
+
+    // Called on the job's thread. Posted events die with the manager,
+    // which waits for the thread before it goes.
+    auto onProgress = [this, id](double position, double duration) {
+        QMetaObject::invokeMethod(
+            this,
+            [this, id, position, duration]() {
+                if (Job* job = findJob(id)) {
+                    job->progress.position = position;
+                    job->progress.duration = duration;
+                    reportProgress(*job);
+                }
+            },
+            Qt::QueuedConnection);
+    };
+    // Hand back the slots the transcoder won't use
+    request.threadsChosen = [this, id](int threads) {
+        QMetaObject::invokeMethod(
+            this,
+            [this, id, threads]() {
+                Job* job = findJob(id);
+                if (job && threads < job->slots) {
+                    job->slots = threads;
+                    startQueuedJobs();
+                }
+            },
+            Qt::QueuedConnection);
+    };
+
+    job.run            = std::make_shared<LibraryRun>();
+    job.run->requested = scheduling;
+    // Segment threads start at the class of the job's thread, but are moved
+    // along with it when the job's priority changes
+    request.threadStarted  = [run = job.run]() { run->addCurrentThread(); };
+    request.threadFinished = [run = job.run]() { run->removeCurrentThread(); };
+
+    job.thread = QThread::create([libav = m_libav, run = job.run, request, onProgress]() {
+        run->addCurrentThread();
+        run->success = libav->transcode(request, run->cancelled, run->error, onProgress);
+        run->removeCurrentThread();
+    });
+    connect(job.thread, &QThread::finished, this, [this, id, run = job.run]() {
+        // Ignore a run that restartJob() replaced after it ended
+        if (const Job* job = findJob(id); job && job->run == run) {
+            finishJob(id, run->success, run->error);
+        }
+    });
+
+    emit transcodingStarted(job.sourcePath);
+    emit outputOpened(job.destPath, job.writePath);
+
+    job.thread->start();
+#else
+    finishJob(job.id, false, "Built without in-process transcoding support");
+#endif
+}
+
+void TranscodingManager::finishJob(JobId id, bool success, const QString& errorMsg)
+{
+    const auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [id](const auto& job) { return job->id == id; });
+    if (it == m_jobs.end()) {
+        return;
+    }
+
+    const std::unique_ptr<Job> job = std::move(*it);
+    m_jobs.erase(it);
+
+    const bool started = job->started();
+    if (job->process) {
+        job->process->disconnect(this);
+        job->process->deleteLater();
+    }
+    if (job->thread) {
+        // Only reached from the thread's finished signal
+        job->thread->deleteLater();
+    }
+
+    // Cached outputs only appear under their final name once complete
+    QString errorMessage = errorMsg;
+    if (success && !job->cancelled && job->cached && !m_cache.commit(job->destPath)) {
+        success = false;
+        errorMessage = "Failed to store transcoded file";
+    }
+
+    if (!job->cancelled && !success) {
+        ++m_stats.failed;
+    }
+
+    if (job->cancelled) {
+        // Incomplete output is useless to anyone
+        if (started) {
+            emit outputClosed(job->destPath);
+            QFile::remove(job->writePath);
+        }
+        qInfo() << "Transcoding job" << id << "cancelled";
+    } else if (success) {
+        const double seconds = job->timer.elapsed() / 1000.0;
+        const double encoded = std::max(job->progress.position, job->progress.duration);
+        ++m_stats.finished;
+        m_stats.encodedSeconds += encoded;
+        m_stats.busySeconds += seconds;
+        if (encoded > 0.0 && encoded < seconds) {
+            ++m_stats.slowerThanRealtime;
+        }
+
+        qInfo() << "Transcoding finished successfully:" << job->sourcePath
+                << QString("(%1 s of audio in %2 s, %3x realtime)")
+                       .arg(encoded, 0, 'f', 1)
+                       .arg(seconds, 0, 'f', 1)
+                       .arg(seconds > 0.0 ? encoded / seconds : 0.0, 0, 'f', 1);
+        emit transcodingFinished(job->sourcePath, job->destPath);
+        emit outputClosed(job->destPath);
+    } else {
+        qWarning() << "Transcoding job" << id << "failed:" << errorMessage;
+        emit transcodingError(job->sourcePath, errorMessage);
+        if (started) {
+            emit outputClosed(job->destPath);
+        }
+        if (job->cached) {
+            QFile::remove(job->writePath);
+        }
+    }
+
+    emit jobEnded(id);
+
+    // Deferred, as this may be running inside QProcess::start()
+    QMetaObject::invokeMethod(this, &TranscodingManager::startQueuedJobs, Qt::QueuedConnection);
+}
 
-    // Build ffmpeg arguments
+QStringList TranscodingManager::ffmpegArguments(const Job& job, int threads)
+{
     QStringList args;
+    args << "-hide_banner" << "-nostats";
+    args << "-progress" << "pipe:1"; // key=value progress blocks on stdout
     args << "-y";  // Overwrite output file
-    args << "-i" << sourcePath;
+    if (job.startOffset > 0.0) {
+        // Before -i: seeks the input instead of decoding up to the offset
+        args << "-ss" << QString::number(job.startOffset, 'f', 3);
+    }
+    if (threads > 0) {
+        args << "-threads" << QString::number(threads); // Decoder
+    }
+    args << "-i" << job.sourcePath;
+    args << "-vn"; // Drop embedded cover art
+    args << "-flush_packets" << "1"; // Make output readable as it is encoded
+
+    // Down to what the receiver takes; dithered when the bit depth drops
+    QStringList resample;
+    if (job.conversion.sampleRate > 0) {
+        resample << QString("osr=%1").arg(job.conversion.sampleRate);
+    }
+    if (job.conversion.bitDepth > 0) {
+        // The FLAC encoder writes s32 input as 24-bit
+        const QString sampleFormat = job.conversion.bitDepth <= 16 ? QStringLiteral("s16") : QStringLiteral("s32");
+        resample << "osf=" + sampleFormat << "dither_method=triangular_hp";
+    }
+    if (!resample.isEmpty()) {
+        args << "-af" << "aresample=" + resample.join(':');
+    }
+    if (job.conversion.channels > 0) {
+        args << "-ac" << QString::number(job.conversion.channels);
+    }
+
+    args << "-codec:a" << encoderName(job.format);
+    if (threads > 0) {
+        args << "-threads" << QString::number(threads); // Encoder and filters
+    }
+    if (const int quality = vbrQuality(job.format, job.quality); quality >= 0) {
+        args << "-q:a" << QString::number(quality);
+    } else if (const int kbps = bitrate(job.format, job.quality); kbps > 0) {
+        args << "-b:a" << QString("%1k").arg(kbps);
+    }
+
+    // Add output file; the muxer is explicit as cached outputs are written
+    // under a temporary name
+    args << "-f" << muxerName(job.format);
+    args << job.writePath;
+
+    return args;
+}
 
-    // Set codec based on format
+QString TranscodingManager::encoderName(TranscodingFormat format)
+{
     switch (format) {
         case TranscodingFormat::MP3:
-            args << "-codec:a" << "libmp3lame";
-            break;
+            return "libmp3lame";
         case TranscodingFormat::AAC:
-            args << "-codec:a" << "aac";
-            break;
+            return "aac";
         case TranscodingFormat::Opus:
-            args << "-codec:a" << "libopus";
-            break;
+            return "libopus";
         case TranscodingFormat::FLAC:
-            args << "-codec:a" << "flac";
-            break;
+            return "flac";
         case TranscodingFormat::Vorbis:
-            args << "-codec:a" << "libvorbis";
-            break;
+            return "libvorbis";
         case TranscodingFormat::WAV:
-            args << "-codec:a" << "pcm_s16le";
-            break;
+            return "pcm_s16le";
+        default:
+            return "aac";
     }
+}
 
-    // Set bitrate/quality based on quality setting
+int TranscodingManager::bitrate(TranscodingFormat format, TranscodingQuality quality)
+{
     switch (quality) {
         case TranscodingQuality::High:
             if (format == TranscodingFormat::MP3) {
-                args << "-b:a" << "320k";
+                return 320;
             } else if (format == TranscodingFormat::AAC) {
-                args << "-b:a" << "256k";
+                return 256;
             } else if (format == TranscodingFormat::Opus) {
-                args << "-b:a" << "192k";
-            } else if (format == TranscodingFormat::Vorbis) {
-                args << "-q:a" << "8";
+                return 192;
             }
             break;
         case TranscodingQuality::Balanced:
             if (format == TranscodingFormat::MP3) {
-                args << "-b:a" << "192k";
+                return 192;
             } else if (format == TranscodingFormat::AAC) {
-                args << "-b:a" << "160k";
+                return 160;
             } else if (format == TranscodingFormat::Opus) {
-                args << "-b:a" << "128k";
-            } else if (format == TranscodingFormat::Vorbis) {
-                args << "-q:a" << "5";
+                return 128;
             }
             break;
         case TranscodingQuality::Efficient:
             if (format == TranscodingFormat::MP3) {
-                args << "-b:a" << "128k";
+                return 128;
             } else if (format == TranscodingFormat::AAC) {
-                args << "-b:a" << "96k";
+                return 96;
             } else if (format == TranscodingFormat::Opus) {
-                args << "-b:a" << "96k";
-            } else if (format == TranscodingFormat::Vorbis) {
-                args << "-q:a" << "3";
+                return 96;
             }
             break;
     }
+    return 0;
+}
 
-    // Add output file
-    args << destPath;
-
-    qInfo() << "Running: ffmpeg" << args.join(" ");
+int TranscodingManager::vbrQuality(TranscodingFormat format, TranscodingQuality quality)
+{
+    if (format != TranscodingFormat::Vorbis) {
+        return -1;
+    }
 
-    emit transcodingStarted(sourcePath);
-    m_transcodeProcess->start("ffmpeg", args);
+    switch (quality) {
+        case TranscodingQuality::High:
+            return 8;
+        case TranscodingQuality::Balanced:
+            return 5;
+        case TranscodingQuality::Efficient:
+            return 3;
+    }
+    return -1;
+}
 
-    // Wait briefly to check if process started
-    if (!m_transcodeProcess->waitForStarted(1000)) {
-        qWarning() << "Failed to start ffmpeg:" << m_transcodeProcess->errorString();
-        qWarning() << "Note: Install ffmpeg for audio transcoding support";
-        emit transcodingError(sourcePath, "Failed to start ffmpeg. Please install ffmpeg.");
-        m_currentSourcePath.clear();
-        m_currentDestPath.clear();
-        return false;
+int TranscodingManager::estimatedBitrate(TranscodingFormat format, TranscodingQuality quality)
+{
+    if (const int kbps = bitrate(format, quality); kbps > 0) {
+        return kbps;
     }
 
-    return true;
+    switch (format) {
+        case TranscodingFormat::FLAC:
+            return 900; // CD audio, varies with the music
+        case TranscodingFormat::WAV:
+            return 1411;
+        case TranscodingFormat::Vorbis:
+            switch (quality) {
+                case TranscodingQuality::High:
+                    return 256;
+                case TranscodingQuality::Balanced:
+                    return 160;
+                case TranscodingQuality::Efficient:
+                    return 112;
+            }
+            break;
+        default:
+            break;
+    }
+    return 320;
 }
 
 QString TranscodingManager::supportedFormats() const
@@ -185,6 +1206,46 @@ QString TranscodingManager::formatName(TranscodingFormat format) const
     }
 }
 
+QString TranscodingManager::fileExtension(TranscodingFormat format)
+{
+    switch (format) {
+        case TranscodingFormat::AAC:
+            return "aac"; // ADTS - MP4 writes its index last
+        case TranscodingFormat::MP3:
+            return "mp3";
+        case TranscodingFormat::Opus:
+            return "opus";
+        case TranscodingFormat::FLAC:
+            return "flac";
+        case TranscodingFormat::Vorbis:
+            return "ogg";
+        case TranscodingFormat::WAV:
+            return "wav";
+        default:
+            return "mp3";
+    }
+}
+
+QString TranscodingManager::muxerName(TranscodingFormat format)
+{
+    switch (format) {
+        case TranscodingFormat::AAC:
+            return "adts";
+        case TranscodingFormat::MP3:
+            return "mp3";
+        case TranscodingFormat::Opus:
+            return "opus";
+        case TranscodingFormat::FLAC:
+            return "flac";
+        case TranscodingFormat::Vorbis:
+            return "ogg";
+        case TranscodingFormat::WAV:
+            return "wav";
+        default:
+            return "mp3";
+    }
+}
+
 QString TranscodingManager::qualityName(TranscodingQuality quality) const
 {
     switch (quality) {
@@ -199,65 +1260,151 @@ QString TranscodingManager::qualityName(TranscodingQuality quality) const
     }
 }
 
-void TranscodingManager::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void TranscodingManager::onProcessFinished(JobId id, int exitCode, QProcess::ExitStatus exitStatus)
 {
+    // Whatever is still buffered
+    onProcessOutput(id);
+
     if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-        qInfo() << "Transcoding finished successfully:" << m_currentSourcePath;
-        emit transcodingFinished(m_currentSourcePath, m_currentDestPath);
-    }
-    else {
-        QString errorMsg = QString("Transcoding failed with code %1").arg(exitCode);
-        qWarning() << errorMsg;
-        emit transcodingError(m_currentSourcePath, errorMsg);
+        finishJob(id, true);
+        return;
     }
 
-    m_currentSourcePath.clear();
-    m_currentDestPath.clear();
+    QString error = QString("Transcoding failed with code %1").arg(exitCode);
+    if (const Job* job = findJob(id); job && !job->cancelled && !job->errorTail.isEmpty()) {
+        qWarning() << "ffmpeg output for job" << id << ":\n" << qUtf8Printable(job->errorTail.join("\n"));
+        error = QString("%1: %2").arg(error, job->errorTail.constLast());
+    }
+    finishJob(id, false, error);
 }
 
-void TranscodingManager::onProcessError(QProcess::ProcessError error)
+void TranscodingManager::onProcessError(JobId id, QProcess::ProcessError error)
 {
-    QString errorMsg;
+    const Job* job = findJob(id);
+    if (!job) {
+        return;
+    }
+
     switch (error) {
         case QProcess::FailedToStart:
-            errorMsg = "Failed to start transcoding process";
+            // No finished signal follows
+            qWarning() << "Failed to start ffmpeg:" << job->process->errorString();
+            qWarning() << "Note: Install ffmpeg for audio transcoding support";
+            finishJob(id, false, "Failed to start ffmpeg. Please install ffmpeg.");
             break;
         case QProcess::Crashed:
-            errorMsg = "Transcoding process crashed";
-            break;
-        case QProcess::Timedout:
-            errorMsg = "Transcoding timed out";
+            if (!job->cancelled) {
+                qWarning() << "Transcoding process crashed:" << job->sourcePath;
+            }
             break;
         default:
-            errorMsg = "Unknown transcoding error";
+            qWarning() << "Transcoding process error:" << job->process->errorString();
             break;
     }
+}
 
-    qWarning() << errorMsg << ":" << m_transcodeProcess->errorString();
-    emit transcodingError(m_currentSourcePath, errorMsg);
+void TranscodingManager::onProcessOutput(JobId id)
+{
+    Job* job = findJob(id);
+    if (!job || !job->process) {
+        return;
+    }
+
+    job->errorOutput += job->process->readAllStandardError();
+    const QList<QByteArray> logLines = takeLines(job->errorOutput);
+    for (const QByteArray& line : logLines) {
+        parseLogLine(*job, line);
+    }
 
-    m_currentSourcePath.clear();
-    m_currentDestPath.clear();
+    job->output += job->process->readAllStandardOutput();
+    const QList<QByteArray> progressLines = takeLines(job->output);
+    bool blockEnded{false};
+    for (const QByteArray& line : progressLines) {
+        blockEnded |= parseProgressLine(*job, line);
+    }
+
+    // Last, as receivers of the signal may end the job
+    if (blockEnded) {
+        reportProgress(*job);
+    }
 }
 
-void TranscodingManager::onProcessOutput()
+bool TranscodingManager::parseProgressLine(Job& job, const QByteArray& line)
 {
-    QByteArray output = m_transcodeProcess->readAllStandardOutput();
-    QByteArray error = m_transcodeProcess->readAllStandardError();
-
-    if (!output.isEmpty()) {
-        qDebug() << "Transcoding output:" << QString::fromUtf8(output).trimmed();
+    const qsizetype separator = line.indexOf('=');
+    if (separator <= 0) {
+        return false;
     }
 
-    if (!error.isEmpty()) {
-        qWarning() << "Transcoding error:" << QString::fromUtf8(error).trimmed();
+    const QByteArray key   = line.left(separator);
+    const QByteArray value = line.mid(separator + 1).trimmed();
+
+    // out_time_ms is in microseconds too; only newer ffmpeg has out_time_us
+    if (key == "out_time_us" || key == "out_time_ms") {
+        bool ok{false};
+        const qint64 us = value.toLongLong(&ok);
+        if (ok && us >= 0) {
+            job.progress.position = static_cast<double>(us) / 1000000.0;
+        }
     }
+    else if (key == "speed") {
+        // "12.3x", or "N/A" before the first frame
+        bool ok{false};
+        const double speed = value.chopped(value.endsWith('x') ? 1 : 0).toDouble(&ok);
+        job.reportedSpeed  = ok && std::isfinite(speed) ? speed : 0.0;
+    }
+    else if (key == "progress") {
+        return true;
+    }
+    return false;
 }
 
+void TranscodingManager::parseLogLine(Job& job, const QByteArray& line)
+{
+    qDebug() << "ffmpeg:" << line;
 
-bool TranscodingManager::isProcessRunning() const
+    job.errorTail.append(QString::fromUtf8(line));
+    while (job.errorTail.size() > ErrorTailLines) {
+        job.errorTail.removeFirst();
+    }
+
+    // The input is described once, before encoding starts
+    static const QRegularExpression durationLine(QStringLiteral(R"(^Duration: (\d+):(\d{2}):(\d{2}(?:\.\d+)?))"));
+    if (job.progress.duration <= 0.0) {
+        const QRegularExpressionMatch match = durationLine.match(QString::fromUtf8(line));
+        if (match.hasMatch()) {
+            const double source = match.captured(1).toDouble() * 3600.0 + match.captured(2).toDouble() * 60.0
+                                + match.captured(3).toDouble();
+            // out_time counts from the start of the output
+            job.progress.duration = std::max(0.0, source - job.startOffset);
+        }
+    }
+}
+
+void TranscodingManager::reportProgress(Job& job)
 {
-    return m_transcodeProcess->state() == QProcess::Running;
+    const qint64 elapsed = job.timer.elapsed();
+
+    job.progress.priority = job.priority;
+    if (job.reportedSpeed > 0.0) {
+        job.progress.speed = job.reportedSpeed;
+    }
+    else if (elapsed > 0) {
+        job.progress.speed = job.progress.position * 1000.0 / static_cast<double>(elapsed);
+    }
+
+    const bool complete = job.progress.duration > 0.0 && job.progress.position >= job.progress.duration;
+    if (!complete && job.lastReport >= 0 && elapsed - job.lastReport < ProgressInterval) {
+        return;
+    }
+    job.lastReport = elapsed;
+
+    const JobId id           = job.id;
+    const Progress progress = job.progress;
+    emit jobProgress(id, progress);
+    if (const int percent = progress.percent(); percent >= 0) {
+        emit transcodingProgress(progress.sourcePath, percent);
+    }
 }
 
 } // namespace Chromecast
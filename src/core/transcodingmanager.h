@@ -16,49 +16,384 @@
  * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #pragma once
 
+#include "devicecapabilities.h"
+#include "mediaprobe.h"
+#include "schedulingclass.h"
+#include "transcodecache.h"
+
 #include <chromecast/chromecast_common.h>
 
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QObject>
 #include <QProcess>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QThread;
 
 namespace Chromecast {
+class LibavTranscoder;
 
+/*!
+ * Queue of transcoding jobs run by a bounded pool of workers.
+ *
+ * Each job runs either as an ffmpeg process or, when the plugin is built
+ * with libav support, on a thread of its own using LibavTranscoder.
+ *
+ * Jobs start in priority order, oldest first within a priority. Playback
+ * jobs are never held back by the pool limit, so the track being cast
+ * doesn't wait for background work. A request for the same source, format
+ * and quality as a queued or running job joins that job instead of
+ * starting another; the job is only cancelled once every requester has
+ * cancelled it.
+ *
+ * Jobs submitted without a destination are written to the persistent
+ * TranscodeCache, so a track is only ever encoded once per format and
+ * quality.
+ *
+ * A job can start part way into the source, so a seek past what a running
+ * job has encoded so far can be served from a fresh job at once instead of
+ * waiting for the first to get there.
+ *
+ * Running jobs report how far they have got and how fast they encode
+ * relative to playback, read from ffmpeg's -progress output or from
+ * LibavTranscoder's callback.
+ *
+ * Sources above the receiver's sample rate, bit depth or channel count are
+ * converted down to it, with dither when the bit depth drops. Lossless
+ * sources the receiver can't take as they are can be kept lossless as
+ * FLAC at its limits instead of being encoded to the lossy output format.
+ *
+ * Each priority has a SchedulingClass: playback jobs run at normal CPU and
+ * disk priority, background ones by default only on what is left idle.
+ *
+ * With the Library backend, a long track started while workers are idle
+ * is split into segments that are encoded on those workers' share of the
+ * cores at once and joined into one continuous output. Each segment
+ * thread holds a worker slot until the job ends, so queued jobs wait for
+ * them like for any other running job.
+ */
 class TranscodingManager : public QObject
 {
     Q_OBJECT
 
 public:
+    enum class Priority
+    {
+        Background, // Speculative work, e.g. upcoming tracks
+        Normal,
+        Playback    // Needed by the track that is being cast right now
+    };
+    Q_ENUM(Priority)
+
+    enum class Backend
+    {
+        Process, // ffmpeg command line
+        Library  // In-process libavformat/libavcodec
+    };
+    Q_ENUM(Backend)
+
+    using JobId = quint64;
+
+    struct Progress
+    {
+        QString sourcePath;
+        Priority priority{Priority::Normal};
+        double position{0.0}; // Seconds of audio encoded
+        double duration{0.0}; // Length of the source in seconds, 0 if unknown
+        double speed{0.0};    // Seconds encoded per second of wall time, 0 if unknown
+
+        // 0-100, or -1 if the duration is unknown
+        [[nodiscard]] int percent() const;
+        // Estimated seconds until the job ends, or -1 if unknown
+        [[nodiscard]] double remaining() const;
+        // Whether playback from the start of the output, beginning now,
+        // stays behind the encode until it ends at the current speed
+        [[nodiscard]] bool staysAheadOfPlayback() const;
+    };
+
+    // Totals over the jobs that have ended since startup
+    struct Stats
+    {
+        int finished{0};
+        int failed{0};
+        int slowerThanRealtime{0}; // Finished jobs that encoded below 1x on average
+        double encodedSeconds{0.0};
+        double busySeconds{0.0};   // Wall time spent by finished jobs
+
+        [[nodiscard]] double averageSpeed() const
+        {
+            return busySeconds > 0.0 ? encodedSeconds / busySeconds : 0.0;
+        }
+    };
+
     explicit TranscodingManager(QObject* parent = nullptr);
     ~TranscodingManager() override;
 
+    // Whether the receiver can play the file as it is, judged by its
+    // probed codec, container, sample rate and bit depth
     bool isFormatSupported(const QString& filePath) const;
+    // Whether the file must be transcoded before the receiver can play it.
+    // Lossless files are also transcoded when they exceed the bitrate limit.
+    bool needsTranscoding(const QString& filePath) const;
+    // Codec and stream parameters of a file, cached until it changes
+    MediaInfo mediaInfo(const QString& filePath) const;
+    // The three above read files that haven't been probed yet, which can take
+    // seconds with ffprobe. Callers on the GUI thread that can wait probe
+    // here first and come back on mediaProbed().
+    [[nodiscard]] bool isProbed(const QString& filePath) const;
+    void probeInBackground(const QStringList& filePaths);
+
+    // What the receiver being cast to plays natively
+    void setDeviceCapabilities(const DeviceCapabilities& capabilities);
+    [[nodiscard]] const DeviceCapabilities& deviceCapabilities() const;
+
+    // Format and quality to cast tracks that need transcoding in
+    void setOutputFormat(TranscodingFormat format, TranscodingQuality quality);
+    // Highest bitrate in kbit/s the receiver's link sustains, 0 for none.
+    // The output steps down from the configured format and quality until
+    // it fits, or to the cheapest encode if nothing does. A lower rate only
+    // applies once it has been reported for a while, and a higher one with
+    // some headroom kept, so a link near a step doesn't flip the output.
+    void setBitrateLimit(int kbps);
+    [[nodiscard]] int bitrateLimit() const;
+    // What is actually used for new jobs, after the bitrate limit
+    [[nodiscard]] TranscodingFormat outputFormat() const;
+    [[nodiscard]] TranscodingQuality outputQuality() const;
+    // Format to transcode sourcePath to: FLAC for lossless sources while
+    // keepLossless() is on and the link carries it, else outputFormat()
+    [[nodiscard]] TranscodingFormat outputFormatFor(const QString& sourcePath) const;
+    void setKeepLossless(bool enabled);
+    [[nodiscard]] bool keepLossless() const;
+
+    // Queue a transcode and return its job ID, or 0 if it can't be queued.
+    // The output goes to outputPath(id), which differs from destPath if
+    // the request joined an existing job.
+    JobId transcode(const QString& sourcePath, const QString& destPath,
+                    TranscodingFormat format = TranscodingFormat::AAC,
+                    TranscodingQuality quality = TranscodingQuality::High, Priority priority = Priority::Normal);
+    // Same, with the output going to the transcode cache
+    JobId transcode(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality,
+                    Priority priority = Priority::Normal);
+    // Same, starting startOffset (> 0) seconds into the source. The output
+    // is temporary: it isn't cached and the caller removes it when done.
+    JobId transcodeFrom(const QString& sourcePath, double startOffset, TranscodingFormat format,
+                        TranscodingQuality quality, Priority priority = Priority::Playback);
     bool transcodeFile(const QString& sourcePath, const QString& destPath,
                        TranscodingFormat format = TranscodingFormat::AAC,
                        TranscodingQuality quality = TranscodingQuality::High);
+    // Drop one request for the job; the job stops when none are left
+    void cancel(JobId id);
+    void cancelAll();
+
+    // Complete cached output for the source, empty if it must be transcoded
+    QString cachedOutput(const QString& sourcePath, TranscodingFormat format, TranscodingQuality quality);
+    // Same without touching hit/miss statistics or LRU order
+    [[nodiscard]] bool isCached(const QString& sourcePath, TranscodingFormat format,
+                                TranscodingQuality quality) const;
+    // Where the cached output for the source is or will be once transcoded
+    [[nodiscard]] QString cachePath(const QString& sourcePath, TranscodingFormat format,
+                                    TranscodingQuality quality) const;
+    void setCacheSize(qint64 bytes);
+    [[nodiscard]] TranscodeCache::Stats cacheStats() const;
+
+    [[nodiscard]] QString outputPath(JobId id) const;
+    [[nodiscard]] bool isActive(JobId id) const;
+    [[nodiscard]] int queuedJobCount() const;
+    [[nodiscard]] int runningJobCount() const;
+    // Latest progress of a running job, all zero while it is queued
+    [[nodiscard]] Progress progress(JobId id) const;
+    [[nodiscard]] Stats stats() const;
+
+    // Used for jobs started from now on
+    void setBackend(Backend backend);
+    [[nodiscard]] Backend backend() const;
+    static bool isBackendAvailable(Backend backend);
+    static Backend defaultBackend();
+
+    // CPU and disk priority of jobs with the given priority, also applied
+    // to those already running
+    void setSchedulingClass(Priority priority, const SchedulingClass& scheduling);
+    [[nodiscard]] SchedulingClass schedulingClass(Priority priority) const;
+    static SchedulingClass defaultSchedulingClass(Priority priority);
+
+    // Worker slots for transcodes: one per job, or per segment thread of a
+    // segmented one. Playback jobs start regardless but hold slots too.
+    void setMaxConcurrentJobs(int count);
+    [[nodiscard]] int maxConcurrentJobs() const;
+    static int defaultMaxConcurrentJobs();
+
     QString supportedFormats() const;
     QString formatName(TranscodingFormat format) const;
+    // Extension of a container for format that can be read while it is written
+    static QString fileExtension(TranscodingFormat format);
+    // ffmpeg muxer for fileExtension(format)
+    static QString muxerName(TranscodingFormat format);
+    // ffmpeg encoder for format
+    static QString encoderName(TranscodingFormat format);
+    // Target bitrate in kbit/s, 0 if the format is lossless or quality based
+    static int bitrate(TranscodingFormat format, TranscodingQuality quality);
+    // Encoder quality scale, -1 if the format is bitrate based
+    static int vbrQuality(TranscodingFormat format, TranscodingQuality quality);
+    // Typical bitrate in kbit/s, also for lossless and quality based formats
+    static int estimatedBitrate(TranscodingFormat format, TranscodingQuality quality);
     QString qualityName(TranscodingQuality quality) const;
 
 signals:
     void transcodingStarted(const QString& sourcePath);
     void transcodingProgress(const QString& sourcePath, int progress);
+    // Emitted at most a few times per second for each running job
+    void jobProgress(Chromecast::TranscodingManager::JobId id,
+                     const Chromecast::TranscodingManager::Progress& progress);
+    // The job has left the queue, finished, failed or cancelled
+    void jobEnded(Chromecast::TranscodingManager::JobId id);
+    // outputFormat() or outputQuality() changed
+    void outputFormatChanged();
+    // Which files need transcoding may have changed
+    void deviceCapabilitiesChanged();
+    // A probe started by probeInBackground() is done; isProbed() is now true
+    void mediaProbed(const QString& filePath);
     void transcodingFinished(const QString& sourcePath, const QString& destPath);
     void transcodingError(const QString& sourcePath, const QString& error);
+    // The output file has been created and is being written. writePath is
+    // where the data is until it is complete, if that differs from destPath.
+    void outputOpened(const QString& destPath, const QString& writePath);
+    // The job has ended, successfully or not; destPath won't grow further
+    void outputClosed(const QString& destPath);
 
 private slots:
-    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onProcessError(QProcess::ProcessError error);
-    void onProcessOutput();
+    void startQueuedJobs();
 
 private:
-    bool isProcessRunning() const;
+    // Output parameters reduced to what the receiver takes, 0 to keep the source's
+    struct Downconversion
+    {
+        int sampleRate{0};
+        int bitDepth{0};
+        int channels{0};
+
+        bool operator==(const Downconversion& other) const = default;
+        // TranscodeCache variant of outputs converted this way
+        [[nodiscard]] QString variant() const;
+    };
+
+    // Shared with the thread of a Library job
+    struct LibraryRun
+    {
+        std::atomic<bool> cancelled{false};
+        bool success{false};
+        QString error;
+
+        // Called on each thread working on the run as it starts and ends,
+        // so scheduling changes reach all of them
+        void addCurrentThread();
+        void removeCurrentThread();
+        // Move the run's threads, and those it starts later, to scheduling.
+        // Returns false if one of them can't be moved.
+        bool setScheduling(const SchedulingClass& scheduling);
+        // What the run's threads were given, as far as known
+        [[nodiscard]] SchedulingClass scheduling() const;
+
+        mutable QMutex lock;
+        SchedulingClass requested; // For threads that start later
+        SchedulingClass current;
+        std::vector<qint64> threadIds; // SchedulingClass::currentThreadId() of each
+    };
+
+    struct Job
+    {
+        JobId id{0};
+        QString sourcePath;
+        QString destPath;
+        QString writePath;            // destPath, or its ".part" name for cached outputs
+        bool cached{false};
+        TranscodingFormat format{TranscodingFormat::AAC};
+        TranscodingQuality quality{TranscodingQuality::High};
+        Priority priority{Priority::Normal};
+        double startOffset{0.0};      // Seconds into the source the output starts at
+        Downconversion conversion;
+        int requests{1};              // Coalesced requesters still interested
+        QProcess* process{nullptr};   // Process backend, null while queued
+        QThread* thread{nullptr};     // Library backend, null while queued
+        std::shared_ptr<LibraryRun> run;
+        bool cancelled{false};
+        int slots{1};                 // Worker slots held while started, one per thread
+        SchedulingClass scheduling;   // What the worker runs at, as far as known
+
+        Progress progress;
+        QElapsedTimer timer;          // Started with the job
+        qint64 lastReport{-1};        // timer time of the last jobProgress
+        QByteArray output;            // ffmpeg output not yet parsed, by line
+        QByteArray errorOutput;
+        QStringList errorTail;        // Last lines ffmpeg logged, reported on failure
+        double reportedSpeed{0.0};    // As printed by ffmpeg
+
+        [[nodiscard]] bool started() const
+        {
+            return process || thread;
+        }
+    };
+
+    static QStringList ffmpegArguments(const Job& job, int threads);
+
+    Job* findJob(JobId id) const;
+    Job* nextQueuedJob() const;
+    // Worker slots held by started jobs, compared against m_maxConcurrentJobs
+    int usedSlots() const;
+    void startJob(Job& job);
+    void startProcessJob(Job& job);
+    void startLibraryJob(Job& job);
+    void finishJob(JobId id, bool success, const QString& errorMsg = {});
+    // After the job's priority changed while it runs
+    // Returns false if the job's worker couldn't be changed to its class
+    bool applyScheduling(Job& job);
+    // Stop the job's worker and start it again from the beginning once it
+    // has stopped
+    void restartJob(Job& job);
+
+    void onProcessFinished(JobId id, int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(JobId id, QProcess::ProcessError error);
+    void onProcessOutput(JobId id);
+    // Returns true at the end of a progress block
+    static bool parseProgressLine(Job& job, const QByteArray& line);
+    static void parseLogLine(Job& job, const QByteArray& line);
+    // Emit the job's progress unless it was reported very recently
+    void reportProgress(Job& job);
+
+    void updateOutputFormat();
+    [[nodiscard]] Downconversion downconversion(const QString& sourcePath, TranscodingFormat format) const;
+
+    JobId addJob(const QString& sourcePath, const QString& destPath, bool cached, TranscodingFormat format,
+                 TranscodingQuality quality, Priority priority, double startOffset = 0.0);
 
-    QProcess* m_transcodeProcess{nullptr};
-    QString m_currentSourcePath;
-    QString m_currentDestPath;
+    TranscodeCache m_cache;
+    mutable MediaProbe m_probe;
+    QThreadPool m_probePool;  // Waited for on destruction
+    QSet<QString> m_probing;  // Queued on m_probePool
+    DeviceCapabilities m_capabilities{DeviceCapabilities::forModel({})};
+    Backend m_backend{Backend::Process};
+    std::shared_ptr<LibavTranscoder> m_libav; // Shared with running Library jobs
+    TranscodingFormat m_preferredFormat{TranscodingFormat::AAC};
+    TranscodingQuality m_preferredQuality{TranscodingQuality::High};
+    int m_bitrateLimit{0};          // Applied limit, after hysteresis
+    QElapsedTimer m_limitLowSince;  // Since rates below m_bitrateLimit are reported
+    bool m_keepLossless{true};
+    TranscodingFormat m_outputFormat{TranscodingFormat::AAC};    // After m_bitrateLimit
+    TranscodingQuality m_outputQuality{TranscodingQuality::High};
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    JobId m_nextJobId{1};
+    Stats m_stats;
+    std::array<SchedulingClass, 3> m_scheduling; // By Priority
+    int m_maxConcurrentJobs;
 };
 
 } // namespace Chromecast
@@ -0,0 +1,192 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "pretranscoder.h"
+
+#include "../core/communicationmanager.h"
+#include "../core/transcodingmanager.h"
+
+#include <core/player/playbackqueue.h>
+#include <core/player/playercontroller.h>
+#include <core/playlist/playlist.h>
+#include <core/playlist/playlisthandler.h>
+#include <core/track.h>
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace Chromecast {
+
+PreTranscoder::PreTranscoder(TranscodingManager* transcoder, CommunicationManager* communication,
+                             Fooyin::PlayerController* playerController, Fooyin::PlaylistHandler* playlistHandler,
+                             QObject* parent)
+    : QObject(parent)
+    , m_transcoder(transcoder)
+    , m_communication(communication)
+    , m_playerController(playerController)
+    , m_playlistHandler(playlistHandler)
+{
+    if (m_playerController) {
+        // Queued, so ChromecastOutput joins the job for the new current track
+        // before we drop our request on it
+        connect(m_playerController, &Fooyin::PlayerController::currentTrackChanged, this, &PreTranscoder::refresh,
+                Qt::QueuedConnection);
+    }
+    connect(m_communication, &CommunicationManager::connectionStatusChanged, this, &PreTranscoder::refresh);
+    // Outputs for the old settings would never be used
+    connect(m_transcoder, &TranscodingManager::outputFormatChanged, this, &PreTranscoder::refresh);
+    connect(m_transcoder, &TranscodingManager::deviceCapabilitiesChanged, this, &PreTranscoder::refresh);
+    connect(m_transcoder, &TranscodingManager::mediaProbed, this, [this](const QString& filePath) {
+        if (m_unprobed.remove(filePath)) {
+            refresh();
+        }
+    });
+}
+
+PreTranscoder::~PreTranscoder()
+{
+    cancelAll();
+}
+
+void PreTranscoder::setLookahead(int tracks)
+{
+    m_lookahead = std::max(0, tracks);
+    refresh();
+}
+
+int PreTranscoder::lookahead() const
+{
+    return m_lookahead;
+}
+
+void PreTranscoder::refresh()
+{
+    // Only worth the CPU when the tracks are going to be cast
+    if (m_lookahead == 0 || !m_communication->isConnected()) {
+        m_unprobed.clear();
+        cancelAll();
+        emit upcomingFilesChanged({});
+        return;
+    }
+
+    const TranscodingQuality quality = m_transcoder->outputQuality();
+    const QStringList upcoming = upcomingTracks();
+
+    // Deciding needs a probe of the file, which may take seconds: have that
+    // done off this thread and decide on the track when it is back
+    m_unprobed.clear();
+    for (const QString& path : upcoming) {
+        if (!m_transcoder->isProbed(path)) {
+            m_unprobed.insert(path);
+        }
+    }
+    m_transcoder->probeInBackground(m_unprobed.values());
+
+    QHash<QString, quint64> jobs;
+    QStringList files = upcoming;
+    for (const QString& path : upcoming) {
+        if (m_unprobed.contains(path)) {
+            continue;
+        }
+        if (!m_transcoder->needsTranscoding(path)) {
+            continue;
+        }
+        // Lossless sources may stay lossless, so the format is per track
+        const TranscodingFormat format = m_transcoder->outputFormatFor(path);
+        files.append(m_transcoder->cachePath(path, format, quality));
+        if (m_transcoder->isCached(path, format, quality)) {
+            continue;
+        }
+
+        const QString key = QString("%1|%2|%3").arg(path).arg(static_cast<int>(format)).arg(static_cast<int>(quality));
+        if (jobs.contains(key)) {
+            continue;
+        }
+
+        // Keep jobs that are still upcoming rather than requeueing them
+        const quint64 existing = m_jobs.take(key);
+        if (existing != 0 && m_transcoder->isActive(existing)) {
+            jobs.insert(key, existing);
+            continue;
+        }
+
+        const quint64 id = m_transcoder->transcode(path, format, quality, TranscodingManager::Priority::Background);
+        if (id != 0) {
+            qInfo() << "Pre-transcoding upcoming track:" << path;
+            jobs.insert(key, id);
+        }
+    }
+
+    // Whatever is left is no longer upcoming (or was started by playback,
+    // which holds its own request on the job)
+    cancelAll();
+    m_jobs = std::move(jobs);
+
+    emit upcomingFilesChanged(files);
+}
+
+QStringList PreTranscoder::upcomingTracks() const
+{
+    QStringList paths;
+    if (!m_playerController) {
+        return paths;
+    }
+
+    const auto addTrack = [&paths](const Fooyin::Track& track) {
+        if (track.isValid() && !track.filepath().isEmpty()) {
+            paths.append(track.filepath());
+        }
+    };
+
+    // Explicitly queued tracks play first
+    const auto queued = m_playerController->playbackQueue().tracks();
+    for (const auto& playlistTrack : queued) {
+        if (paths.size() >= m_lookahead) {
+            return paths;
+        }
+        addTrack(playlistTrack.track);
+    }
+
+    if (!m_playlistHandler) {
+        return paths;
+    }
+
+    const Fooyin::Playlist* playlist = m_playlistHandler->activePlaylist();
+    if (!playlist) {
+        return paths;
+    }
+
+    const auto tracks = playlist->tracks();
+    const auto count = static_cast<int>(tracks.size());
+    for (int index = playlist->currentTrackIndex() + 1; index < count && paths.size() < m_lookahead; ++index) {
+        addTrack(tracks.at(static_cast<size_t>(index)));
+    }
+
+    return paths;
+}
+
+void PreTranscoder::cancelAll()
+{
+    for (const quint64 id : std::as_const(m_jobs)) {
+        m_transcoder->cancel(id);
+    }
+    m_jobs.clear();
+}
+
+} // namespace Chromecast
@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright 2026, Sundararajan Mohan
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+namespace Fooyin {
+class PlayerController;
+class PlaylistHandler;
+class Track;
+}
+
+namespace Chromecast {
+
+class CommunicationManager;
+class TranscodingManager;
+
+/*!
+ * Transcodes the next few tracks in the background while a device is
+ * connected, so the cached output is ready when playback reaches them and
+ * LOAD can be sent without waiting for ffmpeg.
+ *
+ * Upcoming tracks are taken from the playback queue first, then from the
+ * active playlist after the current track. Tracks that haven't been probed
+ * yet are probed in the background first and looked at again once that is
+ * done, so working out what to transcode never blocks the GUI.
+ */
+class PreTranscoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultLookahead = 2;
+
+    PreTranscoder(TranscodingManager* transcoder, CommunicationManager* communication,
+                  Fooyin::PlayerController* playerController, Fooyin::PlaylistHandler* playlistHandler,
+                  QObject* parent = nullptr);
+    ~PreTranscoder() override;
+
+    // Number of upcoming tracks to prepare, 0 disables pre-transcoding
+    void setLookahead(int tracks);
+    [[nodiscard]] int lookahead() const;
+
+public slots:
+    // Recompute the upcoming tracks and (re)queue their jobs
+    void refresh();
+
+signals:
+    // The upcoming tracks and the outputs being transcoded for them, whose
+    // media URLs should stay valid until they play
+    void upcomingFilesChanged(const QStringList& filePaths);
+
+private:
+    [[nodiscard]] QStringList upcomingTracks() const;
+    void cancelAll();
+
+    TranscodingManager* m_transcoder;
+    CommunicationManager* m_communication;
+    Fooyin::PlayerController* m_playerController;
+    Fooyin::PlaylistHandler* m_playlistHandler;
+
+    int m_lookahead{DefaultLookahead};
+    QHash<QString, quint64> m_jobs; // Job key -> TranscodingManager::JobId
+    QSet<QString> m_unprobed;       // Upcoming tracks waiting for their probe
+};
+
+} // namespace Chromecast
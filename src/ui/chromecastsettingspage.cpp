@@ -21,8 +21,11 @@
 #include "devicewidget.h"
 
 #include "../core/transcodingmanager.h"
+#include "../core/liveencoder.h"
 #include "../core/discoverymanager.h"
 #include "../core/communicationmanager.h"
+#include "../core/httpserver.h"
+#include "../integration/pretranscoder.h"
 #include <utils/settings/settingsmanager.h>
 
 #include <QFormLayout>
@@ -34,35 +37,95 @@
 #include <QComboBox>
 #include <QSpinBox>
 
+#include <algorithm>
+
 namespace Chromecast {
 
 ChromecastSettingsPageWidget::ChromecastSettingsPageWidget(Fooyin::SettingsManager* settings, TranscodingManager* transcoder,
-                                                           DiscoveryManager* discovery, CommunicationManager* communication)
+                                                           DiscoveryManager* discovery, CommunicationManager* communication,
+                                                           HttpServer* httpServer)
     : m_settings(settings)
     , m_transcoder(transcoder)
     , m_discovery(discovery)
     , m_communication(communication)
+    , m_httpServer(httpServer)
     , m_deviceWidget(nullptr)
     , m_formatComboBox(nullptr)
     , m_qualityComboBox(nullptr)
+    , m_adaptiveQualityCheckBox(nullptr)
+    , m_keepLosslessCheckBox(nullptr)
+    , m_backendComboBox(nullptr)
+    , m_streamSourceComboBox(nullptr)
+    , m_liveFormatComboBox(nullptr)
+    , m_livePcmBitsComboBox(nullptr)
+    , m_transcodeWorkersSpinBox(nullptr)
+    , m_backgroundNiceSpinBox(nullptr)
+    , m_backgroundIdleIoCheckBox(nullptr)
+    , m_backgroundThreadsSpinBox(nullptr)
+    , m_preTranscodeSpinBox(nullptr)
+    , m_transcodeCacheSpinBox(nullptr)
+    , m_transcodeCacheStatsLabel(nullptr)
+    , m_transcodeStatsLabel(nullptr)
     , m_portSpinBox(nullptr)
     , m_discoveryTimeoutSpinBox(nullptr)
+    , m_httpThreadsSpinBox(nullptr)
+    , m_coverCacheSpinBox(nullptr)
+    , m_coverSizeSpinBox(nullptr)
+    , m_registryStatsLabel(nullptr)
 {
     initializeSettings();
     setupUI();
+
+    if (m_transcoder) {
+        connect(m_transcoder, &TranscodingManager::transcodingFinished, this,
+                &ChromecastSettingsPageWidget::updateCacheStats);
+        connect(m_transcoder, &TranscodingManager::transcodingError, this,
+                &ChromecastSettingsPageWidget::updateCacheStats);
+    }
 }
 
 void ChromecastSettingsPageWidget::load()
 {
     int defaultFormat = m_settings->value("Chromecast/DefaultFormat").toInt();
     int defaultQuality = m_settings->value("Chromecast/DefaultQuality").toInt();
+    bool adaptiveQuality = m_settings->value("Chromecast/AdaptiveQuality").toBool();
+    bool keepLossless = m_settings->value("Chromecast/KeepLossless").toBool();
+    int transcodeBackend = m_settings->value("Chromecast/TranscodeBackend").toInt();
+    bool liveStreaming = m_settings->value("Chromecast/LiveStreaming").toBool();
+    int liveFormat = m_settings->value("Chromecast/LiveFormat").toInt();
+    int livePcmBits = m_settings->value("Chromecast/LivePcmBits").toInt();
+    int transcodeWorkers = m_settings->value("Chromecast/TranscodeWorkers").toInt();
+    int backgroundNice = m_settings->value("Chromecast/BackgroundNice").toInt();
+    bool backgroundIdleIo = m_settings->value("Chromecast/BackgroundIdleIo").toBool();
+    int backgroundThreads = m_settings->value("Chromecast/BackgroundThreads").toInt();
+    int transcodeCacheSize = m_settings->value("Chromecast/TranscodeCacheSize").toInt();
+    int preTranscodeTracks = m_settings->value("Chromecast/PreTranscodeTracks").toInt();
     int serverPort = m_settings->value("Chromecast/ServerPort").toInt();
     int discoveryTimeout = m_settings->value("Chromecast/DiscoveryTimeout").toInt();
+    int httpThreads = m_settings->value("Chromecast/HttpWorkerThreads").toInt();
+    int coverCacheSize = m_settings->value("Chromecast/CoverCacheSize").toInt();
+    int coverMaxSize = m_settings->value("Chromecast/CoverMaxSize").toInt();
 
     m_formatComboBox->setCurrentIndex(defaultFormat);
     m_qualityComboBox->setCurrentIndex(defaultQuality);
+    m_adaptiveQualityCheckBox->setChecked(adaptiveQuality);
+    m_keepLosslessCheckBox->setChecked(keepLossless);
+    m_backendComboBox->setCurrentIndex(std::max(0, m_backendComboBox->findData(transcodeBackend)));
+    m_streamSourceComboBox->setCurrentIndex(std::max(0, m_streamSourceComboBox->findData(liveStreaming)));
+    m_liveFormatComboBox->setCurrentIndex(std::max(0, m_liveFormatComboBox->findData(liveFormat)));
+    m_livePcmBitsComboBox->setCurrentIndex(std::max(0, m_livePcmBitsComboBox->findData(livePcmBits)));
+    m_transcodeWorkersSpinBox->setValue(transcodeWorkers);
+    m_backgroundNiceSpinBox->setValue(backgroundNice);
+    m_backgroundIdleIoCheckBox->setChecked(backgroundIdleIo);
+    m_backgroundThreadsSpinBox->setValue(backgroundThreads);
+    m_transcodeCacheSpinBox->setValue(transcodeCacheSize);
+    m_preTranscodeSpinBox->setValue(preTranscodeTracks);
+    updateCacheStats();
     m_portSpinBox->setValue(serverPort);
     m_discoveryTimeoutSpinBox->setValue(discoveryTimeout);
+    m_httpThreadsSpinBox->setValue(httpThreads);
+    m_coverCacheSpinBox->setValue(coverCacheSize);
+    m_coverSizeSpinBox->setValue(coverMaxSize);
 }
 
 void ChromecastSettingsPageWidget::apply()
@@ -70,6 +133,92 @@ void ChromecastSettingsPageWidget::apply()
     // Save transcoding settings
     m_settings->set("Chromecast/DefaultFormat", m_formatComboBox->currentData().toInt());
     m_settings->set("Chromecast/DefaultQuality", m_qualityComboBox->currentData().toInt());
+    if (m_transcoder) {
+        m_transcoder->setOutputFormat(static_cast<TranscodingFormat>(m_formatComboBox->currentData().toInt()),
+                                      static_cast<TranscodingQuality>(m_qualityComboBox->currentData().toInt()));
+    }
+
+    bool newAdaptiveQuality = m_adaptiveQualityCheckBox->isChecked();
+    if (newAdaptiveQuality != m_settings->value("Chromecast/AdaptiveQuality").toBool()) {
+        m_settings->set("Chromecast/AdaptiveQuality", newAdaptiveQuality);
+        // When enabled, the limit follows from the next measurement
+        if (m_transcoder && !newAdaptiveQuality) {
+            m_transcoder->setBitrateLimit(0);
+        }
+        qInfo() << "Chromecast: Adaptive quality" << (newAdaptiveQuality ? "enabled" : "disabled");
+    }
+
+    bool newKeepLossless = m_keepLosslessCheckBox->isChecked();
+    if (newKeepLossless != m_settings->value("Chromecast/KeepLossless").toBool()) {
+        m_settings->set("Chromecast/KeepLossless", newKeepLossless);
+        if (m_transcoder) {
+            m_transcoder->setKeepLossless(newKeepLossless);
+        }
+        qInfo() << "Chromecast: Keep lossless sources lossless" << (newKeepLossless ? "enabled" : "disabled");
+    }
+
+    int newBackend = m_backendComboBox->currentData().toInt();
+    if (newBackend != m_settings->value("Chromecast/TranscodeBackend").toInt()) {
+        m_settings->set("Chromecast/TranscodeBackend", newBackend);
+        if (m_transcoder) {
+            m_transcoder->setBackend(static_cast<TranscodingManager::Backend>(newBackend));
+        }
+        qInfo() << "Chromecast: Transcoding backend changed to" << m_backendComboBox->currentText();
+    }
+
+    bool newLiveStreaming = m_streamSourceComboBox->currentData().toBool();
+    int newLiveFormat = m_liveFormatComboBox->currentData().toInt();
+    int newLivePcmBits = m_livePcmBitsComboBox->currentData().toInt();
+    if (newLiveStreaming != m_settings->value("Chromecast/LiveStreaming").toBool()
+        || newLiveFormat != m_settings->value("Chromecast/LiveFormat").toInt()
+        || newLivePcmBits != m_settings->value("Chromecast/LivePcmBits").toInt()) {
+        m_settings->set("Chromecast/LiveStreaming", newLiveStreaming);
+        m_settings->set("Chromecast/LiveFormat", newLiveFormat);
+        m_settings->set("Chromecast/LivePcmBits", newLivePcmBits);
+        qInfo() << "Chromecast: Stream source changed to" << m_streamSourceComboBox->currentText() << "as"
+                << m_liveFormatComboBox->currentText() << "(restart required)";
+    }
+
+    int newPreTranscode = m_preTranscodeSpinBox->value();
+    if (newPreTranscode != m_settings->value("Chromecast/PreTranscodeTracks").toInt()) {
+        m_settings->set("Chromecast/PreTranscodeTracks", newPreTranscode);
+        qInfo() << "Chromecast: Pre-transcoded tracks changed to" << newPreTranscode << "(restart required)";
+    }
+
+    int newWorkers = m_transcodeWorkersSpinBox->value();
+    if (newWorkers != m_settings->value("Chromecast/TranscodeWorkers").toInt()) {
+        m_settings->set("Chromecast/TranscodeWorkers", newWorkers);
+        if (m_transcoder) {
+            m_transcoder->setMaxConcurrentJobs(newWorkers);
+        }
+        qInfo() << "Chromecast: Transcoding workers changed to" << newWorkers;
+    }
+
+    const SchedulingClass newBackground{m_backgroundNiceSpinBox->value(), m_backgroundIdleIoCheckBox->isChecked(),
+                                        m_backgroundThreadsSpinBox->value()};
+    const SchedulingClass oldBackground{m_settings->value("Chromecast/BackgroundNice").toInt(),
+                                        m_settings->value("Chromecast/BackgroundIdleIo").toBool(),
+                                        m_settings->value("Chromecast/BackgroundThreads").toInt()};
+    if (newBackground != oldBackground) {
+        m_settings->set("Chromecast/BackgroundNice", newBackground.niceness);
+        m_settings->set("Chromecast/BackgroundIdleIo", newBackground.idleIo);
+        m_settings->set("Chromecast/BackgroundThreads", newBackground.threads);
+        if (m_transcoder) {
+            m_transcoder->setSchedulingClass(TranscodingManager::Priority::Background, newBackground);
+        }
+        qInfo() << "Chromecast: Background transcoding priority changed to nice" << newBackground.niceness
+                << (newBackground.idleIo ? "with idle disk access" : "");
+    }
+
+    int newCacheSize = m_transcodeCacheSpinBox->value();
+    if (newCacheSize != m_settings->value("Chromecast/TranscodeCacheSize").toInt()) {
+        m_settings->set("Chromecast/TranscodeCacheSize", newCacheSize);
+        if (m_transcoder) {
+            m_transcoder->setCacheSize(static_cast<qint64>(newCacheSize) * 1024 * 1024);
+        }
+        qInfo() << "Chromecast: Transcode cache size changed to" << newCacheSize << "MB";
+        updateCacheStats();
+    }
 
     // Save network settings
     int newPort = m_portSpinBox->value();
@@ -82,6 +231,30 @@ void ChromecastSettingsPageWidget::apply()
 
     m_settings->set("Chromecast/DiscoveryTimeout", m_discoveryTimeoutSpinBox->value());
 
+    int newThreads = m_httpThreadsSpinBox->value();
+    if (newThreads != m_settings->value("Chromecast/HttpWorkerThreads").toInt()) {
+        m_settings->set("Chromecast/HttpWorkerThreads", newThreads);
+        qInfo() << "Chromecast: HTTP worker threads changed to" << newThreads << "(restart required)";
+    }
+
+    int newCoverCacheSize = m_coverCacheSpinBox->value();
+    if (newCoverCacheSize != m_settings->value("Chromecast/CoverCacheSize").toInt()) {
+        m_settings->set("Chromecast/CoverCacheSize", newCoverCacheSize);
+        if (m_httpServer) {
+            m_httpServer->setCoverCacheSize(static_cast<qint64>(newCoverCacheSize) * 1024 * 1024);
+        }
+        qInfo() << "Chromecast: Cover cache size changed to" << newCoverCacheSize << "MB";
+    }
+
+    int newCoverMaxSize = m_coverSizeSpinBox->value();
+    if (newCoverMaxSize != m_settings->value("Chromecast/CoverMaxSize").toInt()) {
+        m_settings->set("Chromecast/CoverMaxSize", newCoverMaxSize);
+        if (m_httpServer) {
+            m_httpServer->setCoverMaxDimension(newCoverMaxSize);
+        }
+        qInfo() << "Chromecast: Cover art size limit changed to" << newCoverMaxSize << "px";
+    }
+
     qInfo() << "Chromecast settings saved";
 }
 
@@ -119,12 +292,63 @@ void ChromecastSettingsPageWidget::initializeSettings()
     if (!m_settings->contains("Chromecast/DefaultQuality")) {
         m_settings->createSetting("Chromecast/DefaultQuality", static_cast<int>(TranscodingQuality::High));
     }
+    if (!m_settings->contains("Chromecast/AdaptiveQuality")) {
+        m_settings->createSetting("Chromecast/AdaptiveQuality", true);
+    }
+    if (!m_settings->contains("Chromecast/KeepLossless")) {
+        m_settings->createSetting("Chromecast/KeepLossless", true);
+    }
+    if (!m_settings->contains("Chromecast/TranscodeBackend")) {
+        m_settings->createSetting("Chromecast/TranscodeBackend", static_cast<int>(TranscodingManager::defaultBackend()));
+    }
+    if (!m_settings->contains("Chromecast/LiveStreaming")) {
+        m_settings->createSetting("Chromecast/LiveStreaming", false);
+    }
+    if (!m_settings->contains("Chromecast/LiveFormat")) {
+        m_settings->createSetting("Chromecast/LiveFormat",
+                                  static_cast<int>(LiveEncoder::isFormatAvailable(TranscodingFormat::FLAC)
+                                                       ? TranscodingFormat::FLAC
+                                                       : TranscodingFormat::WAV));
+    }
+    if (!m_settings->contains("Chromecast/LivePcmBits")) {
+        m_settings->createSetting("Chromecast/LivePcmBits", 16);
+    }
+    if (!m_settings->contains("Chromecast/TranscodeWorkers")) {
+        m_settings->createSetting("Chromecast/TranscodeWorkers", TranscodingManager::defaultMaxConcurrentJobs());
+    }
+    const SchedulingClass background
+        = TranscodingManager::defaultSchedulingClass(TranscodingManager::Priority::Background);
+    if (!m_settings->contains("Chromecast/BackgroundNice")) {
+        m_settings->createSetting("Chromecast/BackgroundNice", background.niceness);
+    }
+    if (!m_settings->contains("Chromecast/BackgroundIdleIo")) {
+        m_settings->createSetting("Chromecast/BackgroundIdleIo", background.idleIo);
+    }
+    if (!m_settings->contains("Chromecast/BackgroundThreads")) {
+        m_settings->createSetting("Chromecast/BackgroundThreads", background.threads);
+    }
+    if (!m_settings->contains("Chromecast/PreTranscodeTracks")) {
+        m_settings->createSetting("Chromecast/PreTranscodeTracks", PreTranscoder::DefaultLookahead);
+    }
+    if (!m_settings->contains("Chromecast/TranscodeCacheSize")) {
+        m_settings->createSetting("Chromecast/TranscodeCacheSize",
+                                  static_cast<int>(TranscodeCache::DefaultMaxBytes / (1024 * 1024)));
+    }
     if (!m_settings->contains("Chromecast/ServerPort")) {
         m_settings->createSetting("Chromecast/ServerPort", 8010);
     }
     if (!m_settings->contains("Chromecast/DiscoveryTimeout")) {
         m_settings->createSetting("Chromecast/DiscoveryTimeout", 10000);
     }
+    if (!m_settings->contains("Chromecast/HttpWorkerThreads")) {
+        m_settings->createSetting("Chromecast/HttpWorkerThreads", HttpServer::defaultWorkerThreadCount());
+    }
+    if (!m_settings->contains("Chromecast/CoverCacheSize")) {
+        m_settings->createSetting("Chromecast/CoverCacheSize", static_cast<int>(CoverCache::DefaultMaxBytes / (1024 * 1024)));
+    }
+    if (!m_settings->contains("Chromecast/CoverMaxSize")) {
+        m_settings->createSetting("Chromecast/CoverMaxSize", 0);
+    }
 }
 
 void ChromecastSettingsPageWidget::updateUi()
@@ -132,6 +356,36 @@ void ChromecastSettingsPageWidget::updateUi()
     load();
 }
 
+void ChromecastSettingsPageWidget::updateCacheStats()
+{
+    if (m_httpServer) {
+        const MediaRegistry::Stats registry = m_httpServer->registryStats();
+        m_registryStatsLabel->setText(QString("%1 registered (%2 kept for current and upcoming tracks), %3 expired")
+                                          .arg(registry.entries)
+                                          .arg(registry.retained)
+                                          .arg(registry.expired));
+    }
+
+    if (!m_transcoder) {
+        return;
+    }
+
+    const TranscodeCache::Stats stats = m_transcoder->cacheStats();
+    m_transcodeCacheStatsLabel->setText(QString("%1 files, %2 of %3 MB used, %4 hits, %5 misses")
+                                            .arg(stats.files)
+                                            .arg(stats.usedBytes / (1024 * 1024))
+                                            .arg(stats.maxBytes / (1024 * 1024))
+                                            .arg(stats.hits)
+                                            .arg(stats.misses));
+
+    const TranscodingManager::Stats jobs = m_transcoder->stats();
+    m_transcodeStatsLabel->setText(QString("%1 finished at %2x realtime on average, %3 slower than realtime, %4 failed")
+                                       .arg(jobs.finished)
+                                       .arg(jobs.averageSpeed(), 0, 'f', 1)
+                                       .arg(jobs.slowerThanRealtime)
+                                       .arg(jobs.failed));
+}
+
 void ChromecastSettingsPageWidget::setupUI()
 {
     auto* mainLayout = new QVBoxLayout(this);
@@ -141,6 +395,7 @@ void ChromecastSettingsPageWidget::setupUI()
     auto* deviceLayout = new QVBoxLayout(deviceGroup);
 
     m_deviceWidget = new DeviceWidget(m_discovery, m_communication, this);
+    m_deviceWidget->setTranscodingManager(m_transcoder);
     deviceLayout->addWidget(m_deviceWidget);
 
     // Connect device selection to save to settings and connect
@@ -182,6 +437,94 @@ void ChromecastSettingsPageWidget::setupUI()
     m_qualityComboBox->addItem("Efficient", static_cast<int>(TranscodingQuality::Efficient));
     transcodingLayout->addRow("Default quality:", m_qualityComboBox);
 
+    m_adaptiveQualityCheckBox = new QCheckBox("Adapt to the network", transcodingGroup);
+    m_adaptiveQualityCheckBox->setToolTip("Use a lower quality or a lossy format when the link to the device is "
+                                          "too slow for the default, measured while streaming");
+    transcodingLayout->addRow("", m_adaptiveQualityCheckBox);
+
+    m_keepLosslessCheckBox = new QCheckBox("Keep lossless tracks lossless", transcodingGroup);
+    m_keepLosslessCheckBox->setToolTip("Convert lossless tracks the device can't play as they are to FLAC at its "
+                                       "highest sample rate and bit depth instead of the default format");
+    transcodingLayout->addRow("", m_keepLosslessCheckBox);
+
+    m_backendComboBox = new QComboBox(transcodingGroup);
+    m_backendComboBox->addItem("ffmpeg program", static_cast<int>(TranscodingManager::Backend::Process));
+    if (TranscodingManager::isBackendAvailable(TranscodingManager::Backend::Library)) {
+        m_backendComboBox->addItem("Built-in (FFmpeg libraries)", static_cast<int>(TranscodingManager::Backend::Library));
+    }
+    m_backendComboBox->setToolTip("The built-in transcoder starts faster and doesn't need ffmpeg installed");
+    transcodingLayout->addRow("Transcoder:", m_backendComboBox);
+
+    m_liveFormatComboBox = new QComboBox(transcodingGroup);
+    for (const auto format : {TranscodingFormat::FLAC, TranscodingFormat::WAV, TranscodingFormat::Opus}) {
+        if (LiveEncoder::isFormatAvailable(format)) {
+            m_liveFormatComboBox->addItem(TranscodingManager::fileExtension(format).toUpper(),
+                                          static_cast<int>(format));
+        }
+    }
+
+    m_liveFormatComboBox->setToolTip("WAV sends the audio as it is decoded, without encoding it");
+
+    m_streamSourceComboBox = new QComboBox(transcodingGroup);
+    m_streamSourceComboBox->addItem("Track file", false);
+    m_streamSourceComboBox->addItem("Decoded audio (live)", true);
+    m_streamSourceComboBox->setToolTip("Decoded audio plays every format Fooyin can decode, with its DSPs applied, "
+                                       "but can't be seeked by the receiver (restart required)");
+    transcodingLayout->addRow("Stream source:", m_streamSourceComboBox);
+    transcodingLayout->addRow("Live format:", m_liveFormatComboBox);
+
+    m_livePcmBitsComboBox = new QComboBox(transcodingGroup);
+    m_livePcmBitsComboBox->addItem("16-bit", 16);
+    m_livePcmBitsComboBox->addItem("24-bit", 24);
+    m_livePcmBitsComboBox->setToolTip("Sample size of live WAV streams; not every receiver plays 24-bit");
+    transcodingLayout->addRow("Live WAV samples:", m_livePcmBitsComboBox);
+
+    m_transcodeWorkersSpinBox = new QSpinBox(transcodingGroup);
+    m_transcodeWorkersSpinBox->setRange(1, 64);
+    m_transcodeWorkersSpinBox->setValue(TranscodingManager::defaultMaxConcurrentJobs());
+    m_transcodeWorkersSpinBox->setToolTip("Background transcodes run at the same time; the playing track never waits");
+    transcodingLayout->addRow("Transcoding workers:", m_transcodeWorkersSpinBox);
+
+    m_backgroundNiceSpinBox = new QSpinBox(transcodingGroup);
+    m_backgroundNiceSpinBox->setRange(0, 19);
+    m_backgroundNiceSpinBox->setSpecialValueText("Normal");
+    m_backgroundNiceSpinBox->setToolTip("CPU priority of background transcodes as a nice value; 19 only uses "
+                                        "otherwise idle time");
+    transcodingLayout->addRow("Background niceness:", m_backgroundNiceSpinBox);
+
+    m_backgroundIdleIoCheckBox = new QCheckBox("Background transcodes use idle disk time only", transcodingGroup);
+    m_backgroundIdleIoCheckBox->setToolTip("Reads and writes of background transcodes wait while anything else "
+                                           "uses the disk (Linux)");
+    transcodingLayout->addRow("", m_backgroundIdleIoCheckBox);
+
+    m_backgroundThreadsSpinBox = new QSpinBox(transcodingGroup);
+    m_backgroundThreadsSpinBox->setRange(0, 64);
+    m_backgroundThreadsSpinBox->setSpecialValueText("No limit");
+    m_backgroundThreadsSpinBox->setToolTip("Threads each background transcode may use");
+    transcodingLayout->addRow("Background threads:", m_backgroundThreadsSpinBox);
+
+    m_preTranscodeSpinBox = new QSpinBox(transcodingGroup);
+    m_preTranscodeSpinBox->setRange(0, 10);
+    m_preTranscodeSpinBox->setValue(PreTranscoder::DefaultLookahead);
+    m_preTranscodeSpinBox->setSpecialValueText("Off");
+    m_preTranscodeSpinBox->setToolTip("Upcoming tracks to transcode in the background while casting (restart required)");
+    transcodingLayout->addRow("Transcode ahead:", m_preTranscodeSpinBox);
+
+    m_transcodeCacheSpinBox = new QSpinBox(transcodingGroup);
+    m_transcodeCacheSpinBox->setRange(0, 1024 * 1024);
+    m_transcodeCacheSpinBox->setSingleStep(256);
+    m_transcodeCacheSpinBox->setValue(static_cast<int>(TranscodeCache::DefaultMaxBytes / (1024 * 1024)));
+    m_transcodeCacheSpinBox->setSuffix(" MB");
+    m_transcodeCacheSpinBox->setToolTip("Disk space kept for transcoded tracks, least recently played go first");
+    transcodingLayout->addRow("Transcode cache:", m_transcodeCacheSpinBox);
+
+    m_transcodeCacheStatsLabel = new QLabel(transcodingGroup);
+    transcodingLayout->addRow("Cache usage:", m_transcodeCacheStatsLabel);
+
+    m_transcodeStatsLabel = new QLabel(transcodingGroup);
+    m_transcodeStatsLabel->setToolTip("Transcodes since Fooyin started; below 1x the receiver outruns the encoder");
+    transcodingLayout->addRow("Transcodes:", m_transcodeStatsLabel);
+
     mainLayout->addWidget(transcodingGroup);
 
     // Network settings
@@ -200,6 +543,32 @@ void ChromecastSettingsPageWidget::setupUI()
     m_discoveryTimeoutSpinBox->setSuffix(" ms");
     networkLayout->addRow("Discovery timeout:", m_discoveryTimeoutSpinBox);
 
+    m_httpThreadsSpinBox = new QSpinBox(networkGroup);
+    m_httpThreadsSpinBox->setRange(1, 32);
+    m_httpThreadsSpinBox->setValue(HttpServer::defaultWorkerThreadCount());
+    m_httpThreadsSpinBox->setToolTip("Threads serving media to devices (restart required)");
+    networkLayout->addRow("HTTP worker threads:", m_httpThreadsSpinBox);
+
+    m_coverCacheSpinBox = new QSpinBox(networkGroup);
+    m_coverCacheSpinBox->setRange(0, 1024);
+    m_coverCacheSpinBox->setValue(static_cast<int>(CoverCache::DefaultMaxBytes / (1024 * 1024)));
+    m_coverCacheSpinBox->setSuffix(" MB");
+    m_coverCacheSpinBox->setToolTip("Memory used to keep cover art served to devices");
+    networkLayout->addRow("Cover art cache:", m_coverCacheSpinBox);
+
+    m_coverSizeSpinBox = new QSpinBox(networkGroup);
+    m_coverSizeSpinBox->setRange(0, 4096);
+    m_coverSizeSpinBox->setSingleStep(100);
+    m_coverSizeSpinBox->setValue(0);
+    m_coverSizeSpinBox->setSuffix(" px");
+    m_coverSizeSpinBox->setSpecialValueText("Original");
+    m_coverSizeSpinBox->setToolTip("Downscale larger cover art to JPEG before sending it");
+    networkLayout->addRow("Max cover art size:", m_coverSizeSpinBox);
+
+    m_registryStatsLabel = new QLabel(networkGroup);
+    m_registryStatsLabel->setToolTip("Media URLs handed to devices; unused ones expire after a while");
+    networkLayout->addRow("Media URLs:", m_registryStatsLabel);
+
     mainLayout->addWidget(networkGroup);
 
     mainLayout->addStretch();
@@ -216,7 +585,8 @@ void ChromecastSettingsPageWidget::setupUI()
 }
 
 ChromecastSettingsPage::ChromecastSettingsPage(Fooyin::SettingsManager* settings, TranscodingManager* transcoder,
-                                               DiscoveryManager* discovery, CommunicationManager* communication)
+                                               DiscoveryManager* discovery, CommunicationManager* communication,
+                                               HttpServer* httpServer)
     : SettingsPage{settings->settingsDialog()}
 {
     setId("Chromecast.Settings");
@@ -224,9 +594,9 @@ ChromecastSettingsPage::ChromecastSettingsPage(Fooyin::SettingsManager* settings
     setCategory({"Plugins"});
     qInfo() << "ChromecastSettingsPage: Registering settings page with ID:" << "Chromecast.Settings" << "Category: Plugins";
     qInfo() << "ChromecastSettingsPage: SettingsDialog pointer:" << settings->settingsDialog();
-    setWidgetCreator([settings, transcoder, discovery, communication] {
+    setWidgetCreator([settings, transcoder, discovery, communication, httpServer] {
         qInfo() << "ChromecastSettingsPage: Widget creator called - creating ChromecastSettingsPageWidget";
-        return new ChromecastSettingsPageWidget(settings, transcoder, discovery, communication);
+        return new ChromecastSettingsPageWidget(settings, transcoder, discovery, communication, httpServer);
     });
 }
 
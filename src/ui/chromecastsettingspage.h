@@ -21,7 +21,9 @@
 
 #include <utils/settings/settingspage.h>
 
+#include <QCheckBox>
 #include <QComboBox>
+#include <QLabel>
 #include <QSpinBox>
 
 namespace Fooyin {
@@ -34,6 +36,7 @@ class TranscodingManager;
 class DeviceWidget;
 class DiscoveryManager;
 class CommunicationManager;
+class HttpServer;
 
 class ChromecastSettingsPageWidget : public Fooyin::SettingsPageWidget
 {
@@ -41,7 +44,8 @@ class ChromecastSettingsPageWidget : public Fooyin::SettingsPageWidget
 
 public:
     explicit ChromecastSettingsPageWidget(Fooyin::SettingsManager* settings, TranscodingManager* transcoder,
-                                          DiscoveryManager* discovery, CommunicationManager* communication);
+                                          DiscoveryManager* discovery, CommunicationManager* communication,
+                                          HttpServer* httpServer);
 
     void load() override;
     void apply() override;
@@ -56,17 +60,37 @@ private slots:
 private:
     void initializeSettings();
     void updateUi();
+    void updateCacheStats();
     void setupUI();
 
     Fooyin::SettingsManager* m_settings;
     TranscodingManager* m_transcoder;
     DiscoveryManager* m_discovery;
     CommunicationManager* m_communication;
+    HttpServer* m_httpServer;
     DeviceWidget* m_deviceWidget;
     QComboBox* m_formatComboBox;
     QComboBox* m_qualityComboBox;
+    QCheckBox* m_adaptiveQualityCheckBox;
+    QCheckBox* m_keepLosslessCheckBox;
+    QComboBox* m_backendComboBox;
+    QComboBox* m_streamSourceComboBox;
+    QComboBox* m_liveFormatComboBox;
+    QComboBox* m_livePcmBitsComboBox;
+    QSpinBox* m_transcodeWorkersSpinBox;
+    QSpinBox* m_backgroundNiceSpinBox;
+    QCheckBox* m_backgroundIdleIoCheckBox;
+    QSpinBox* m_backgroundThreadsSpinBox;
+    QSpinBox* m_preTranscodeSpinBox;
+    QSpinBox* m_transcodeCacheSpinBox;
+    QLabel* m_transcodeCacheStatsLabel;
+    QLabel* m_transcodeStatsLabel;
     QSpinBox* m_portSpinBox;
     QSpinBox* m_discoveryTimeoutSpinBox;
+    QSpinBox* m_httpThreadsSpinBox;
+    QSpinBox* m_coverCacheSpinBox;
+    QSpinBox* m_coverSizeSpinBox;
+    QLabel* m_registryStatsLabel;
 };
 
 class ChromecastSettingsPage : public Fooyin::SettingsPage
@@ -75,7 +99,8 @@ class ChromecastSettingsPage : public Fooyin::SettingsPage
 
 public:
     explicit ChromecastSettingsPage(Fooyin::SettingsManager* settings, TranscodingManager* transcoder,
-                                     DiscoveryManager* discovery, CommunicationManager* communication);
+                                     DiscoveryManager* discovery, CommunicationManager* communication,
+                                     HttpServer* httpServer);
 };
 
 } // namespace Chromecast
@@ -26,9 +26,12 @@
 
 #include <QMessageBox>
 #include <QDebug>
+#include <QFileInfo>
 #include <QTimer>
 #include <QTransform>
 
+#include <cmath>
+
 namespace Chromecast {
 
 DeviceWidget::DeviceWidget(DiscoveryManager* discovery, CommunicationManager* communication, QWidget* parent)
@@ -196,6 +199,58 @@ QString DeviceWidget::connectionStatusText(Chromecast::ConnectionStatus status)
     }
 }
 
+void DeviceWidget::setTranscodingManager(TranscodingManager* transcoder)
+{
+    if (m_transcoder) {
+        m_transcoder->disconnect(this);
+    }
+
+    m_transcoder = transcoder;
+    m_transcodingJob = 0;
+    ui->transcodingLabel->setVisible(false);
+
+    if (m_transcoder) {
+        connect(m_transcoder, &TranscodingManager::jobProgress, this, &DeviceWidget::onTranscodingProgress);
+        connect(m_transcoder, &TranscodingManager::jobEnded, this, &DeviceWidget::onTranscodingEnded);
+    }
+}
+
+void DeviceWidget::onTranscodingProgress(TranscodingManager::JobId id, const TranscodingManager::Progress& progress)
+{
+    // The track being cast wins over pre-transcoding of upcoming tracks
+    if (id != m_transcodingJob) {
+        if (m_transcodingJob != 0 && progress.priority != TranscodingManager::Priority::Playback) {
+            return;
+        }
+        m_transcodingJob = id;
+    }
+
+    QString text = QString("Transcoding %1").arg(QFileInfo(progress.sourcePath).fileName());
+    if (const int percent = progress.percent(); percent >= 0) {
+        text += QString(": %1%").arg(percent);
+    }
+    if (progress.speed > 0.0) {
+        text += QString(" at %1x").arg(progress.speed, 0, 'f', 1);
+    }
+    if (const double remaining = progress.remaining(); remaining >= 0.0) {
+        text += QString(", %1 s left").arg(static_cast<int>(std::ceil(remaining)));
+    }
+
+    // Below realtime the receiver will catch up with the encoder and stall
+    const bool tooSlow = progress.speed > 0.0 && progress.speed < 1.0 && progress.percent() < 100;
+    ui->transcodingLabel->setText(tooSlow ? text + " - slower than playback" : text);
+    ui->transcodingLabel->setStyleSheet(tooSlow ? "color: #dc3545;" : "color: #6c757d;");
+    ui->transcodingLabel->setVisible(true);
+}
+
+void DeviceWidget::onTranscodingEnded(TranscodingManager::JobId id)
+{
+    if (id == m_transcodingJob) {
+        m_transcodingJob = 0;
+        ui->transcodingLabel->setVisible(false);
+    }
+}
+
 QString DeviceWidget::name() const
 {
     return "Chromecast Device Widget";
@@ -22,6 +22,7 @@
 #include <gui/fywidget.h>
 #include <chromecast/chromecast_common.h>
 #include "../core/device.h"
+#include "../core/transcodingmanager.h"
 
 // Forward declaration for Qt Designer generated UI class
 namespace Ui {
@@ -44,6 +45,9 @@ public:
     QString name() const override;
     QString layoutName() const override;
 
+    // Show progress of the transcode feeding the receiver
+    void setTranscodingManager(TranscodingManager* transcoder);
+
 signals:
     void deviceSelected(const QString& deviceId);
 
@@ -55,6 +59,9 @@ private slots:
     void onDiscoveryFinished();
     void onConnectionStatusChanged(Chromecast::ConnectionStatus status);
     void updateSpinner();
+    void onTranscodingProgress(Chromecast::TranscodingManager::JobId id,
+                               const Chromecast::TranscodingManager::Progress& progress);
+    void onTranscodingEnded(Chromecast::TranscodingManager::JobId id);
 
 private:
     void updateDeviceList();
@@ -68,6 +75,8 @@ private:
     CommunicationManager* m_communication{nullptr};
     QTimer* m_spinnerTimer{nullptr};
     int m_spinnerRotation{0};
+    TranscodingManager* m_transcoder{nullptr};
+    TranscodingManager::JobId m_transcodingJob{0}; // Shown in transcodingLabel
 };
 
 } // namespace Chromecast